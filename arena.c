@@ -0,0 +1,103 @@
+/*
+ * File: arena.c
+ * Author: Maria Fay Garcia
+ * Purpose: Bump pointer arenas.  Blocks are mapped straight from the
+ *          kernel and kept after a reset, so compiling many functions
+ *          reuses the memory of the biggest one
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <sys/mman.h>
+#include "arena.h"
+
+#define BLOCK_SIZE  (1 << 20)     // default bytes per block
+#define HUGE_PAGE   (1 << 21)
+#define ALIGN       8
+
+// globals
+Arena func_arena;
+Arena glob_arena;
+
+
+// map a block with room for at least size bytes
+static ArenaBlock *new_block(size_t size) {
+    size_t bytes = sizeof(ArenaBlock) + (size > BLOCK_SIZE ? size : BLOCK_SIZE);
+    void *map = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+#ifdef MADV_HUGEPAGE
+    if (bytes >= HUGE_PAGE) madvise(map, bytes, MADV_HUGEPAGE);
+#endif
+
+    ArenaBlock *block = (ArenaBlock *)map;
+    block->next = NULL;
+    block->size = bytes - sizeof(ArenaBlock);
+    block->used = 0;
+    return block;
+}
+
+// make sure the current block has size free bytes, return the block
+static ArenaBlock *room_for(Arena *arena, size_t size) {
+    ArenaBlock *cur = arena->cur;
+    if (cur && cur->size - cur->used >= size) return cur;
+
+    // reuse the blocks left over from before a reset first
+    while (cur && cur->next) {
+        cur = cur->next;
+        cur->used = 0;
+        if (cur->size >= size) return arena->cur = cur;
+    }
+
+    ArenaBlock *block = new_block(size);
+    if (cur) {
+        block->next = cur->next;
+        cur->next = block;
+    } else {
+        arena->first = block;
+    } return arena->cur = block;
+}
+
+// size zeroed bytes, like calloc
+void *arena_alloc(Arena *arena, size_t size) {
+    size = (size + ALIGN - 1) & ~(size_t)(ALIGN - 1);
+    ArenaBlock *block = room_for(arena, size);
+
+    void *mem = block->data + block->used;
+    block->used += size;
+    memset(mem, 0, size);
+    return mem;
+}
+
+// a formatted string, sized to fit
+char *arena_sprintf(Arena *arena, const char *fmt, ...) {
+    va_list args;
+
+    // try the space left in the current block first
+    ArenaBlock *block = room_for(arena, 1);
+    size_t left = block->size - block->used;
+    va_start(args, fmt);
+    size_t len = vsnprintf(block->data + block->used, left, fmt, args);
+    va_end(args);
+
+    if (len >= left) {
+        block = room_for(arena, len + 1);
+        va_start(args, fmt);
+        vsnprintf(block->data + block->used, len + 1, fmt, args);
+        va_end(args);
+    }
+
+    char *str = block->data + block->used;
+    block->used += (len + 1 + ALIGN - 1) & ~(size_t)(ALIGN - 1);
+    if (block->used > block->size) block->used = block->size;
+    return str;
+}
+
+// free everything in the arena at once, keeping the blocks
+void arena_reset(Arena *arena) {
+    arena->cur = arena->first;
+    if (arena->cur) arena->cur->used = 0;
+}
@@ -0,0 +1,33 @@
+/*
+ * File: arena.h
+ * Author: Maria Fay Garcia
+ * Purpose: Bump pointer allocation out of large mapped blocks.
+ *          Everything in an arena is released at once by arena_reset
+ */
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stddef.h>
+
+typedef struct arena_block {
+    struct arena_block *next;
+           size_t       size;   // bytes of data
+           size_t       used;
+           char         data[];
+} ArenaBlock;
+
+typedef struct {
+    ArenaBlock *first;
+    ArenaBlock *cur;            // blocks after cur are free for reuse
+} Arena;
+
+// globals
+extern Arena func_arena;        // reset after each function is compiled
+extern Arena glob_arena;        // lives for the whole run
+
+// function stubs
+void  *arena_alloc   (Arena *arena, size_t        size);
+char  *arena_sprintf (Arena *arena, const char    *fmt, ...);
+void   arena_reset   (Arena *arena                    );
+
+#endif  /* __ARENA_H__ */
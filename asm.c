@@ -0,0 +1,115 @@
+/*
+ * File: asm.c
+ * Author: Maria Fay Garcia
+ * Purpose: The mips code of the function being compiled.  Translation
+ *          emits it a line at a time, each split into its op and
+ *          operands, and it is printed once the function is done
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "asm.h"
+#include "arena.h"
+
+AsmBuf asm_code;
+
+// the line being emitted, up to its newline
+static char pending[1024];
+static int  pending_len = 0;
+
+static AsmLine *new_line() {
+    if (asm_code.count == asm_code.cap) {
+        asm_code.cap  = asm_code.cap ? 2 * asm_code.cap : 256;
+        asm_code.line = (AsmLine *)realloc(asm_code.line, asm_code.cap * sizeof(AsmLine));
+    } return &asm_code.line[asm_code.count++];
+}
+
+// fill in a line, for translation and for the peephole rules
+void set_asm_line(AsmLine *line, AsmKind kind, char *op, int num_args, char **args) {
+    line->kind     = kind;
+    line->op       = op;
+    line->num_args = num_args;
+    for (int k = 0; k < ASM_MAX_ARGS; k++) line->arg[k] = k < num_args ? args[k] : NULL;
+}
+
+// split text into a line: a comment, directive or blank line is kept
+// whole, "name:" is a label, otherwise it is an op, a space, and its
+// operands split by ", "
+static void add_line(char *text) {
+    AsmLine *line = new_line();
+    char    *copy = arena_sprintf(&func_arena, "%s", text);
+    int      len  = strlen(copy);
+
+    if (len == 0 || copy[0] == '#' || copy[0] == '.') {
+        set_asm_line(line, ASM_TEXT, copy, 0, NULL);
+    } else if (copy[len - 1] == ':' && !strchr(copy, ' ')) {
+        copy[len - 1] = 0;
+        set_asm_line(line, ASM_LABEL, copy, 0, NULL);
+    } else {
+        char *args[ASM_MAX_ARGS];
+        int   num_args = 0;
+        char *rest     = strchr(copy, ' ');
+        if (rest) {
+            *rest++ = 0;
+            while (rest && num_args < ASM_MAX_ARGS) {
+                args[num_args++] = rest;
+                rest = strstr(rest, ", ");
+                if (rest) {
+                    *rest = 0;
+                    rest += 2;
+                }
+            }
+        } set_asm_line(line, ASM_INSTR, copy, num_args, args);
+    }
+}
+
+// like printf, into the code of the function
+void emit(const char *fmt, ...) {
+    char    buf[1024];
+    va_list args;
+
+    va_start(args, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+
+    for (char *c = buf; *c; c++) {
+        if (*c == '\n') {
+            pending[pending_len] = 0;
+            add_line(pending);
+            pending_len = 0;
+        } else if (pending_len < (int)sizeof(pending) - 1) {
+            pending[pending_len++] = *c;
+        }
+    }
+}
+
+// the number of instrs in the code
+int asm_instr_count() {
+    int n = 0;
+    for (int i = 0; i < asm_code.count; i++) n += asm_code.line[i].kind == ASM_INSTR;
+    return n;
+}
+
+// print the code of the function, and start the next one
+void print_asm() {
+    for (int i = 0; i < asm_code.count; i++) {
+        AsmLine *line = &asm_code.line[i];
+        switch (line->kind) {
+            case ASM_INSTR:
+                printf("%s", line->op);
+                for (int k = 0; k < line->num_args; k++) {
+                    printf("%s%s", k ? ", " : " ", line->arg[k]);
+                } printf("\n");
+                break;
+            case ASM_LABEL:
+                printf("%s:\n", line->op);
+                break;
+            case ASM_TEXT:
+                printf("%s\n", line->op);
+                break;
+            case ASM_NONE:
+                break;
+        }
+    } asm_code.count = 0;
+}
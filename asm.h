@@ -0,0 +1,46 @@
+/*
+ * File: asm.h
+ * Author: Maria Fay Garcia
+ * Purpose: To outline the mips code of the function being compiled,
+ *          held as a list of lines that translation emits into and the
+ *          peephole pass rewrites before it is printed
+ */
+#ifndef __ASM_H__
+#define __ASM_H__
+
+#define ASM_MAX_ARGS 3
+
+typedef enum {
+    ASM_INSTR,          // an op and its operands
+    ASM_LABEL,          // op is the label
+    ASM_TEXT,           // a comment, directive or blank line, op is the text
+    ASM_NONE            // a removed line
+} AsmKind;
+
+typedef struct {
+    AsmKind  kind;
+    char    *op;
+    char    *arg[ASM_MAX_ARGS];
+    int      num_args;
+} AsmLine;
+
+typedef struct {
+    AsmLine *line;
+    int      count;
+    int      cap;
+} AsmBuf;
+
+// the code of the function being compiled, in func_arena
+extern AsmBuf asm_code;
+
+// function stubs
+void     emit            (const char      *fmt, ...);
+void     set_asm_line    (AsmLine        *line,
+                          AsmKind         kind,
+                          char            *op,
+                          int         num_args,
+                          char         **args);
+int      asm_instr_count (                      );
+void     print_asm       (                      );
+
+#endif  /* __ASM_H__ */
@@ -1,4 +1,52 @@
 #include "ast.h"
+#include "symtab.h"
+
+// globals
+ASTNode *ast_nodes = NULL;
+int      ast_count = 1;      // node 0 is the empty tree
+ASTSym  *ast_syms  = NULL;
+static int ast_cap   = 0;
+static int num_syms  = 0;
+static int syms_cap  = 0;
+
+
+/*************** NODE POOL *****************/
+
+// add a zeroed node to the pool, return its index
+// pointers into the pool are only good until the next call
+NodeId ast_new_node(NodeType type, int tok) {
+    if (ast_count >= ast_cap) {
+        ast_cap = ast_cap ? 2 * ast_cap : 1024;
+        ast_nodes = (ASTNode *)realloc(ast_nodes, ast_cap * sizeof(ASTNode));
+    }
+
+    NodeId id = ast_count++;
+    memset(&ast_nodes[id], 0, sizeof(ASTNode));
+    ast_nodes[id].type = type;
+    ast_nodes[id].tok  = tok;
+    return id;
+}
+
+// add an entry to the name side table, return its index
+int ast_new_sym(char *lexeme, symtab_entry *entry) {
+    if (num_syms == syms_cap) {
+        syms_cap = syms_cap ? 2 * syms_cap : 256;
+        ast_syms = (ASTSym *)realloc(ast_syms, syms_cap * sizeof(ASTSym));
+    }
+
+    ast_syms[num_syms].lexeme = lexeme;
+    ast_syms[num_syms].entry  = entry;
+    return num_syms++;
+}
+
+// empty the pool for the next function, keeping its memory
+void ast_reset() {
+    ast_count = 1;
+    num_syms  = 0;
+}
+
+
+/*************** GETTERS *****************/
 
 
 // return the NodeType of the AST node pointed to by ptr
@@ -10,19 +58,19 @@ NodeType ast_node_type(void *ptr) {
 // return a ptr to the name of the function
 char *func_def_name(void *ptr) {
     ASTNode* ast_node = (ASTNode *)ptr;
-    return ast_node->symtab_entry->lexeme;
+    return NODE_ENTRY(ast_node)->lexeme;
 }
 
 // retrun the number of formal parameters for the function
 int func_def_nargs(void *ptr) {
     ASTNode* ast_node = (ASTNode *)ptr;
-    return ast_node->symtab_entry->num_args;
+    return NODE_ENTRY(ast_node)->num_args;
 }
 
 // return a ptr to the ast of the body of the function
 void *func_def_body(void *ptr) {
     ASTNode* ast_node = (ASTNode *)ptr;
-    return ast_node->child1;
+    return AST_PTR(ast_node->child1);
 }
 
 
@@ -34,8 +82,8 @@ char *func_def_argname(void *ptr, int n) {
         ASTNode* ast_node = (ASTNode *)ptr;
 
         ASTNode* cur = ast_node;
-        for (int i = n; i > 0; i--) cur = cur->child0;
-        return cur->symtab_entry->lexeme;
+        for (int i = n; i > 0; i--) cur = AST(cur->child0);
+        return NODE_ENTRY(cur)->lexeme;
     } return NULL;
 }
 
@@ -43,14 +91,14 @@ char *func_def_argname(void *ptr, int n) {
 // return the name of the func being called
 char *func_call_callee(void *ptr) {
     ASTNode* ast_node = (ASTNode *)ptr;
-    return ast_node->symtab_entry->lexeme;
+    return NODE_ENTRY(ast_node)->lexeme;
 }
 
 
 // returns a ptr to the list of arguments of a function call
 void *func_call_args(void *ptr) {
     ASTNode* ast_node = (ASTNode *)ptr;
-    return ast_node->child0;
+    return AST_PTR(ast_node->child0);
     
 }
 
@@ -58,21 +106,21 @@ void *func_call_args(void *ptr) {
 // returns a ptr to the ast of the stmt at the beginning of opt_stmt_list
 void *stmt_list_head(void *ptr) {
     ASTNode* ast_node = (ASTNode *)ptr;
-    return ast_node->child0;
+    return AST_PTR(ast_node->child0);
 }
 
 
 // returns a pointer to the ast of the rest of opt_stmt_list
 void *stmt_list_rest(void *ptr) {
     ASTNode* ast_node = (ASTNode *)ptr;
-    return ast_node->child1;
+    return AST_PTR(ast_node->child1);
 }
 
 
 // returns a ptr to the ast of the fir expr in opt_expr_list
 void *expr_list_head(void *ptr) {
     ASTNode* ast_node = (ASTNode *)ptr;
-    return ast_node->child0;
+    return AST_PTR(ast_node->child0);
 
 }
 
@@ -80,14 +128,14 @@ void *expr_list_head(void *ptr) {
 // returns a ptr to the rest of opt_expr_list
 void *expr_list_rest(void *ptr) {
     ASTNode* ast_node = (ASTNode *)ptr;
-    return ast_node->child1;
+    return AST_PTR(ast_node->child1);
 }
 
 
 // return the name of an identifier
 char *expr_id_name(void *ptr) {
     ASTNode* ast_node = (ASTNode *)ptr;
-    return ast_node->symtab_entry->lexeme;
+    return NODE_ENTRY(ast_node)->lexeme;
 }
 
 
@@ -101,68 +149,68 @@ int expr_intconst_val(void *ptr) {
 // for bool expr, returns ptr to first operand
 void *expr_operand_1(void *ptr) {
     ASTNode* ast_node = (ASTNode *)ptr;
-    return ast_node->child0;
+    return AST_PTR(ast_node->child0);
 }
 
 
 // for bool expr, returns ptr to second operand
 void *expr_operand_2(void *ptr) {
     ASTNode* ast_node = (ASTNode *)ptr;
-    return ast_node->child1;
+    return AST_PTR(ast_node->child1);
 }
 
 
 // returns ptr for if cond
 void *stmt_if_expr(void *ptr) {
     ASTNode* ast_node = (ASTNode *)ptr;
-    return ast_node->child0;
+    return AST_PTR(ast_node->child0);
 }
 
 
 // returns ptr for then body
 void *stmt_if_then(void *ptr) {
     ASTNode* ast_node = (ASTNode *)ptr;
-    return ast_node->child1;
+    return AST_PTR(ast_node->child1);
 }
 
 
 // returns ptr for else body
 void *stmt_if_else(void *ptr) {
     ASTNode* ast_node = (ASTNode *)ptr;
-    return ast_node->child2;
+    return AST_PTR(ast_node->child2);
 }
 
 
 // returns ptr to name of identifier on LHS
 char *stmt_assg_lhs(void *ptr) {
     ASTNode* ast_node = (ASTNode *)ptr;
-    return ast_node->symtab_entry->lexeme;
+    return NODE_ENTRY(ast_node)->lexeme;
 }
 
 
 // returns ptr to expr on RHS
 void *stmt_assg_rhs(void *ptr) {
     ASTNode* ast_node = (ASTNode *)ptr;
-    return ast_node->child0;
+    return AST_PTR(ast_node->child0);
 }
 
 
 // returns ptr to bool expr
 void *stmt_while_expr(void *ptr) {
     ASTNode* ast_node = (ASTNode *)ptr;
-    return ast_node->child0;
+    return AST_PTR(ast_node->child0);
 }
 
 // returns ptr to body
 void *stmt_while_body(void *ptr) {
     ASTNode* ast_node = (ASTNode *)ptr;
-    return ast_node->child1;
+    return AST_PTR(ast_node->child1);
 }
 
 // returns ptr to body
 void *stmt_return_expr(void *ptr) {
     ASTNode* ast_node = (ASTNode *)ptr;
-    return ast_node->child0;
+    return AST_PTR(ast_node->child0);
 }
 
 
@@ -46,25 +46,40 @@ extern int print_ast_flag;
 typedef struct symtab_entry symtab_entry;
 typedef struct instr Instr;
 
+// nodes live in one pool and refer to each other by index
+// index 0 is never a node, it stands for an empty subtree
+typedef unsigned int NodeId;
+
 typedef struct ASTNode {
-           // for semantic checking
-           int line_num;
-           int col_num;
-           char *lexeme;
-           symtab_entry *symtab_entry; // also for code gen
-
-           NodeType              type;
-           int                 intcon;
-    struct ASTNode      *      child0, 
-                        *      child1,
-                        *      child2;
-    
-           // for three address code
-           Instr        *   code_head;
-           Instr        *   code_tail;
-    struct symtab_entry *       place;
+           unsigned char     type;  // a NodeType
+           int                tok;  // index in toks, for diagnostics
+           NodeId          child0,
+                           child1;
+           union {
+               NodeId      child2;  // IF: the else part
+               int            sym;  // named nodes: index in ast_syms
+               int         intcon;  // INTCONST
+           };
 } ASTNode;
 
+// the name a FUNC_DEF, FUNC_CALL, ASSG, IDENTIFIER or formal refers to
+typedef struct {
+           char        *lexeme;     // interned
+           symtab_entry *entry;     // also for code gen
+} ASTSym;
+
+// the nodes of the function being compiled
+extern ASTNode *ast_nodes;
+extern int      ast_count;
+extern ASTSym  *ast_syms;
+
+#define AST(id)        (&ast_nodes[id])
+#define AST_PTR(id)    ((id) ? AST(id) : NULL)
+#define NODE_ENTRY(n)  (ast_syms[(n)->sym].entry)
+
+NodeId ast_new_node (NodeType type, int tok);
+int    ast_new_sym  (char *lexeme, symtab_entry *entry);
+void   ast_reset    ();
 
 // we still need to include code_gen.h for the function stubs
 #include "code_gen.h"
@@ -0,0 +1,207 @@
+/*
+ * File: dataflow_bench.c
+ * Author: Maria Fay Garcia
+ * Purpose: Time the bit vector dataflow solver (dataflow.c) on synthetic
+ *          functions of growing size, and check its answers against a
+ *          plain round robin solver.
+ *
+ *          usage: dataflow_bench [max blocks]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../dataflow.h"
+#include "../opt.h"
+#include "../arena.h"
+
+#define NUM_LOCALS   192
+#define NUM_GLOBALS  64
+#define REPEAT       3
+
+// the compiler's flags live in driver.c, which has its own main
+int chk_decl_flag  = 0;
+int print_ast_flag = 0;
+int gen_code_flag  = 0;
+
+static symtab_entry vars_tab[NUM_LOCALS + NUM_GLOBALS];
+static symtab_entry callee;
+static int          next_label;
+static unsigned int seed = 12345;
+
+static int rnd(int n) {
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 8) % n;
+}
+
+
+/*************** SYNTHETIC FUNCTIONS *****************/
+
+static void emit(OpType op, Operand src1, Operand src2, Operand dest) {
+    if (ir.count == ir.cap) {
+        ir.cap = ir.cap ? 2 * ir.cap : 1024;
+        ir.instr = (Instr *)realloc(ir.instr, ir.cap * sizeof(Instr));
+    }
+
+    Instr *instr = &ir.instr[ir.count++];
+    instr->op   = op;
+    instr->next = 0;
+    instr->src1 = src1;
+    instr->src2 = src2;
+    instr->dest = dest;
+}
+
+static Operand var(int i)   { return new_operand(STPTR, (void *)&vars_tab[i]); }
+static Operand rnd_var()    { return var(rnd(NUM_LOCALS + NUM_GLOBALS)); }
+static Operand label(int l) { return new_operand(LABEL, (void *)&l); }
+
+// a couple of statements of straight line code
+static void straight() {
+    for (int n = 1 + rnd(3); n > 0; n--) {
+        if (rnd(8) == 0) {
+            int one = 1;
+            emit(OP_PARAM, rnd_var(), NO_OPERAND, NO_OPERAND);
+            emit(OP_CALL, new_operand(STPTR, (void *)&callee), new_operand(ICONST, (void *)&one), NO_OPERAND);
+            emit(OP_GET_RETVAL, NO_OPERAND, NO_OPERAND, rnd_var());
+        } else {
+            emit(OP_PLUS, rnd_var(), rnd_var(), rnd_var());
+        }
+    }
+}
+
+// a statement list as the lowering lays it out: ifs and whiles, nested
+static void stmts(int depth, int *blocks, int max_blocks) {
+    while (*blocks < max_blocks) {
+        int kind = depth > 3 ? 0 : rnd(4);
+        if (kind == 0) {
+            straight();
+            if (depth > 0 && rnd(3) == 0) return;
+        } else if (kind == 1) {
+            // if-else: test, then, else, after
+            int then = next_label++, els = next_label++, after = next_label++;
+            emit(OP_GE, rnd_var(), rnd_var(), label(els));
+            emit(OP_GOTO, NO_OPERAND, NO_OPERAND, label(then));
+            emit(OP_LABEL, NO_OPERAND, NO_OPERAND, label(then));
+            *blocks += 4;
+            stmts(depth + 1, blocks, max_blocks);
+            emit(OP_GOTO, NO_OPERAND, NO_OPERAND, label(after));
+            emit(OP_LABEL, NO_OPERAND, NO_OPERAND, label(els));
+            stmts(depth + 1, blocks, max_blocks);
+            emit(OP_LABEL, NO_OPERAND, NO_OPERAND, label(after));
+        } else {
+            // while: top, body, after
+            int top = next_label++, body = next_label++, after = next_label++;
+            emit(OP_LABEL, NO_OPERAND, NO_OPERAND, label(top));
+            emit(OP_GE, rnd_var(), rnd_var(), label(after));
+            emit(OP_GOTO, NO_OPERAND, NO_OPERAND, label(body));
+            emit(OP_LABEL, NO_OPERAND, NO_OPERAND, label(body));
+            *blocks += 4;
+            stmts(depth + 1, blocks, max_blocks);
+            emit(OP_GOTO, NO_OPERAND, NO_OPERAND, label(top));
+            emit(OP_LABEL, NO_OPERAND, NO_OPERAND, label(after));
+        }
+    }
+}
+
+// a function of about num_blocks blocks in ir
+static void make_function(int num_blocks) {
+    int blocks = 0;
+    ir.count = 0;
+    emit(OP_ENTER, NO_OPERAND, NO_OPERAND, new_operand(STPTR, (void *)&callee));
+    stmts(0, &blocks, num_blocks);
+    emit(OP_LEAVE, NO_OPERAND, NO_OPERAND, NO_OPERAND);
+    emit(OP_RETURN, NO_OPERAND, NO_OPERAND, NO_OPERAND);
+}
+
+
+/*************** THE REFERENCE SOLVER *****************/
+
+// visit every block in layout order until nothing changes
+static void round_robin(Dataflow *df, BitWord *res) {
+    int words = df->words;
+    int forward = df->dir == DF_FORWARD;
+    BitWord *meet = (BitWord *)calloc(words + 1, sizeof(BitWord));
+    memset(res, 0, (size_t)cfg.count * words * sizeof(BitWord));
+
+    for (int changed = 1; changed; ) {
+        changed = 0;
+        for (int b = 0; b < cfg.count; b++) {
+            if (cfg.rpo_num[b] < 0) continue;
+            Block *block = &cfg.block[b];
+            memset(meet, 0, words * sizeof(BitWord));
+            int num = forward ? block->num_pred : 2;
+            for (int k = 0; k < num; k++) {
+                int p = forward ? block->pred[k] : block->succ[k];
+                if (p < 0 || cfg.rpo_num[p] < 0) continue;
+                for (int x = 0; x < words; x++) meet[x] |= res[(size_t)p * words + x];
+            }
+            for (int x = 0; x < words; x++) {
+                BitWord v = df->gen[(size_t)b * words + x] | (meet[x] & ~df->kill[(size_t)b * words + x]);
+                if (v != res[(size_t)b * words + x]) changed = 1;
+                res[(size_t)b * words + x] = v;
+            }
+        }
+    } free(meet);
+}
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// time an analysis, return the best time; check its result against the
+// round robin solver when check is set
+static double run(int (*analysis)(Dataflow *), Dataflow *df, int check, int *status) {
+    double best = 1e30;
+    for (int r = 0; r < REPEAT; r++) {
+        double start = now();
+        if (!analysis(df)) return -1;
+        double t = now() - start;
+        if (t < best) best = t;
+    }
+
+    if (check) {
+        BitWord *res = df->dir == DF_FORWARD ? df->out : df->in;
+        size_t size = (size_t)cfg.count * df->words;
+        BitWord *ref = (BitWord *)malloc((size + 1) * sizeof(BitWord));
+        round_robin(df, ref);
+        if (memcmp(ref, res, size * sizeof(BitWord))) {
+            printf("MISMATCH: the solvers disagree\n");
+            *status = 1;
+        } free(ref);
+    } return best;
+}
+
+int main(int argc, char *argv[]) {
+    int max_blocks = argc > 1 ? atoi(argv[1]) : 65536;
+
+    // the variables, the first NUM_LOCALS local
+    for (int i = 0; i < NUM_LOCALS + NUM_GLOBALS; i++) {
+        vars_tab[i].lexeme = (char *)"v";
+        vars_tab[i].type   = VAR;
+        vars_tab[i].scope  = i < NUM_LOCALS ? LOCAL : GLOBAL;
+    }
+    callee.lexeme = (char *)"f";
+    callee.type   = FUNC;
+    callee.scope  = GLOBAL;
+
+    printf("%8s %8s | %9s %8s %10s\n",
+           "blocks", "instrs", "live ms", "visits/b", "ns/b*word");
+
+    int status = 0;
+    for (int n = 1024; n <= max_blocks; n *= 2) {
+        arena_reset(&func_arena);
+        make_function(n);
+        number_vars();
+        build_cfg();
+
+        Dataflow live;
+        int check = n <= 8192;
+        double t_live = run(live_vars, &live, check, &status);
+
+        printf("%8d %8d | %9.3f %8.2f %10.2f\n",
+               cfg.count, ir.count, t_live * 1e3, (double)live.visits / cfg.count,
+               t_live * 1e9 / ((double)cfg.count * live.words));
+    } return status;
+}
@@ -0,0 +1,227 @@
+/*
+ * File: scan_bench.c
+ * Author: Maria Fay Garcia
+ * Purpose: Compare the generated table scanner (scanner.c), with each
+ *          set of run-skipping kernels, against the old function-pointer
+ *          FSA it replaced.
+ *
+ *          usage: scan_bench [file]
+ *          without a file, a synthetic program is scanned
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include "../scanner.h"
+#include "../scan_simd.h"
+
+#define REPEAT 5
+
+extern int line_num;
+extern int col_num;
+extern int tok_off;
+extern int tok_len;
+
+
+/*************** THE OLD ENGINE *****************/
+
+// function-pointer table filled at startup, one indirect call per char
+// kept here only as a reference point
+
+static int (*fp_table[40][128])();
+static char fp_ch;
+
+static int fp_undef()  { return UNDEF; }
+static int fp_ident()  { return 28; }
+static int fp_digit()  { return 29; }
+static int fp_back(int tok) { src_pos--; return tok; }
+static int fp_id_end() { src_pos--; tok_len = src_pos - tok_off; return keywd_or_id(); }
+static int fp_int_end(){ return fp_back(INTCON); }
+static int fp_lparen() { return LPAREN; }
+static int fp_rparen() { return RPAREN; }
+static int fp_lbrace() { return LBRACE; }
+static int fp_rbrace() { return RBRACE; }
+static int fp_comma()  { return COMMA; }
+static int fp_semi()   { return SEMI; }
+static int fp_add()    { return opADD; }
+static int fp_sub()    { return opSUB; }
+static int fp_mul()    { return opMUL; }
+static int fp_s30()    { return 30; }
+static int fp_eq()     { return opEQ; }
+static int fp_assg()   { return fp_back(opASSG); }
+static int fp_s36()    { return 36; }
+static int fp_div()    { return fp_back(opDIV); }
+static int fp_s31()    { return 31; }
+static int fp_ne()     { return opNE; }
+static int fp_not()    { return fp_back(opNOT); }
+static int fp_s32()    { return 32; }
+static int fp_ge()     { return opGE; }
+static int fp_gt()     { return fp_back(opGT); }
+static int fp_s33()    { return 33; }
+static int fp_le()     { return opLE; }
+static int fp_lt()     { return fp_back(opLT); }
+static int fp_s34()    { return 34; }
+static int fp_and()    { return opAND; }
+static int fp_s35()    { return 35; }
+static int fp_or()     { return opOR; }
+static int fp_drop()   { return fp_back(UNDEF); }
+static int fp_s37()    { return 37; }
+static int fp_s38()    { return 38; }
+static int fp_space()  {
+    if (fp_ch == '\n') {
+        col_num = 0;
+        line_num++;
+    } return 39;
+}
+static int fp_final_states[27];
+
+static void fp_setup_table() {
+    for (int i = 0; i < 27; i++) fp_final_states[i] = i+1;
+    for (int i = 0; i < 40; i++)
+        for (int j = 0; j < 128; j++) fp_table[i][j] = fp_undef;
+
+    fp_table[0]['\t'] = fp_table[0]['\n'] = fp_table[0][' '] = fp_space;
+    fp_table[0]['!'] = fp_s31;    fp_table[0]['&'] = fp_s34;
+    fp_table[0]['('] = fp_lparen; fp_table[0][')'] = fp_rparen;
+    fp_table[0]['*'] = fp_mul;    fp_table[0]['+'] = fp_add;
+    fp_table[0][','] = fp_comma;  fp_table[0]['-'] = fp_sub;
+    fp_table[0]['/'] = fp_s36;    fp_table[0][';'] = fp_semi;
+    fp_table[0]['<'] = fp_s33;    fp_table[0]['='] = fp_s30;
+    fp_table[0]['>'] = fp_s32;    fp_table[0]['{'] = fp_lbrace;
+    fp_table[0]['|'] = fp_s35;    fp_table[0]['}'] = fp_rbrace;
+    for (int i = '0'; i <= '9'; i++) fp_table[0][i] = fp_digit;
+    for (int i = 'A'; i <= 'Z'; i++) fp_table[0][i] = fp_ident;
+    for (int i = 'a'; i <= 'z'; i++) fp_table[0][i] = fp_ident;
+
+    for (int i = 0; i < 128; i++) {
+        int is_alnum = (i >= '0' && i <= '9') || (i >= 'A' && i <= 'Z') ||
+                       (i >= 'a' && i <= 'z') || i == '_';
+        fp_table[28][i] = is_alnum ? fp_ident : fp_id_end;
+        fp_table[29][i] = (i >= '0' && i <= '9') ? fp_digit : fp_int_end;
+        fp_table[30][i] = i == '=' ? fp_eq  : fp_assg;
+        fp_table[31][i] = i == '=' ? fp_ne  : fp_not;
+        fp_table[32][i] = i == '=' ? fp_ge  : fp_gt;
+        fp_table[33][i] = i == '=' ? fp_le  : fp_lt;
+        fp_table[34][i] = i == '&' ? fp_and : fp_drop;
+        fp_table[35][i] = i == '|' ? fp_or  : fp_drop;
+        fp_table[36][i] = i == '*' ? fp_s37 : fp_div;
+        fp_table[37][i] = i == '*' ? fp_s38 : fp_s37;
+        fp_table[38][i] = i == '*' ? fp_s38 : (i == '/' ? fp_undef : fp_s37);
+        fp_table[39][i] = (i == ' ' || i == '\t' || i == '\n') ? fp_space : fp_drop;
+    }
+}
+
+static int fp_is_final_state(int state) {
+    for (int i = 0; i < 27; i++) {
+        if (fp_final_states[i] == state) return 1;
+    } return 0;
+}
+
+static int fp_get_token() {
+    int state = 0;
+    while (src_pos < src_len) {
+        if (state == 0) tok_off = src_pos;
+        fp_ch = src_buf[src_pos++];
+        state = fp_table[state][fp_ch & 127]();
+        if (fp_is_final_state(state)) {
+            tok_len = src_pos - tok_off;
+            return state;
+        } col_num++;
+    } return EOF;
+}
+
+
+/*************** DRIVER *****************/
+
+static char *snippet =
+    "/*\n"
+    " * f -- a function with the usual amount of commentary about what\n"
+    " *      it does, what it assumes and what it returns to its caller\n"
+    " */\n"
+    "int f(int a, int b) {\n"
+    "    int counter_value, x1;\n"
+    "    /* a comment that spans\n"
+    "       a couple of lines */\n"
+    "    while (counter_value <= 1000 && a != b || x1 >= 12345) {\n"
+    "        counter_value = counter_value + (a * b - 7) / 3;\n"
+    "    }\n"
+    "    if (a == b) return -a; else return b;\n"
+    "}\n\n";
+
+// build a large synthetic program in src_buf
+static void make_input(int size) {
+    int n = strlen(snippet);
+    src_buf = (char *)malloc(size + n);
+    src_len = 0;
+    while (src_len < size) {
+        memcpy(src_buf + src_len, snippet, n);
+        src_len += n;
+    }
+}
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// scan the whole buffer REPEAT times, return the best time
+static double run(int (*scan)(), long *ntoks, long *checksum) {
+    double best = 1e30;
+    for (int r = 0; r < REPEAT; r++) {
+        long n = 0, sum = 0;
+        int tok;
+        src_pos = 0;
+        line_num = 1;
+        col_num = 0;
+
+        double start = now();
+        while ((tok = scan()) != EOF) {
+            n++;
+            sum += tok * 31 + tok_len;
+        }
+        double t = now() - start;
+
+        if (t < best) best = t;
+        *ntoks = n;
+        *checksum = sum;
+    } return best;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1) {
+        int fd = open(argv[1], O_RDONLY);
+        if (fd < 0) {
+            perror(argv[1]);
+            return 1;
+        } load_source(fd);
+    } else {
+        make_input(32 << 20);
+    }
+
+    fp_setup_table();
+
+    long n_fp, sum_fp;
+    double t_fp = run(fp_get_token, &n_fp, &sum_fp);
+
+    double mb = src_len / (1024.0 * 1024.0);
+    printf("input: %.1f MB, %ld tokens\n", mb, n_fp);
+    printf("function-pointer FSA:        %8.3f s  %8.1f MB/s\n", t_fp, mb / t_fp);
+
+    char *names[] = { "scalar", "SSE2" };
+    int status = 0;
+    for (KernelLevel level = KERNELS_SCALAR; level <= KERNELS_SSE2; level++) {
+        if (!use_kernels(level)) continue;
+
+        long n_tab, sum_tab;
+        double t_tab = run(get_token, &n_tab, &sum_tab);
+        printf("generated table FSA, %-6s %8.3f s  %8.1f MB/s  (%.2fx)\n",
+               names[level], t_tab, mb / t_tab, t_fp / t_tab);
+
+        if (n_tab != n_fp || sum_tab != sum_fp) {
+            printf("MISMATCH: the engines disagree\n");
+            status = 1;
+        }
+    } return status;
+}
@@ -0,0 +1,189 @@
+/*
+ * File: cfg.c
+ * Author: Maria Fay Garcia
+ * Purpose: Split the three address code of a function into basic
+ *          blocks, and find where control goes after each one
+ */
+#include <limits.h>
+#include "cfg.h"
+#include "arena.h"
+
+CFG cfg;
+
+// whether control may leave the straight line after op
+int ends_block(OpType op) {
+    return op == OP_GOTO || op == OP_RETURN || is_cond_branch(op);
+}
+
+// whether op jumps to its dest label if its comparison holds
+int is_cond_branch(OpType op) {
+    return op >= OP_EQ && op <= OP_GE;
+}
+
+// the block that starts with label, -1 if it is not in this function
+int label_block(int label) {
+    int i = label - cfg.lbl_base;
+    if (i < 0 || i >= cfg.lbl_count) return -1;
+    return cfg.lbl_block[i];
+}
+
+// fill in the predecessors of each block, from the successors
+static void find_preds() {
+    for (int b = 0; b < cfg.count; b++) cfg.block[b].num_pred = 0;
+    for (int b = 0; b < cfg.count; b++) {
+        for (int k = 0; k < 2; k++) {
+            int s = cfg.block[b].succ[k];
+            if (s >= 0) cfg.block[s].num_pred++;
+        }
+    }
+
+    // every block's list lives in one array, there are at most two edges a block
+    int *preds = (int *)arena_alloc(&func_arena, (2 * cfg.count + 1) * sizeof(int));
+    for (int b = 0; b < cfg.count; b++) {
+        cfg.block[b].pred = preds;
+        preds += cfg.block[b].num_pred;
+        cfg.block[b].num_pred = 0;
+    }
+
+    for (int b = 0; b < cfg.count; b++) {
+        for (int k = 0; k < 2; k++) {
+            int s = cfg.block[b].succ[k];
+            if (s >= 0) cfg.block[s].pred[cfg.block[s].num_pred++] = b;
+        }
+    }
+}
+
+// number the blocks reachable from the entry in reverse postorder:
+// but for back edges, a block comes after every block that leads to it
+// a depth first search with an explicit stack of (block, next succ)
+static void find_rpo() {
+    cfg.rpo     = (int *)arena_alloc(&func_arena, (cfg.count + 1) * sizeof(int));
+    cfg.rpo_num = (int *)arena_alloc(&func_arena, (cfg.count + 1) * sizeof(int));
+    cfg.num_rpo = 0;
+    for (int b = 0; b < cfg.count; b++) cfg.rpo_num[b] = -1;
+    if (cfg.count == 0) return;
+
+    int *stack = (int *)arena_alloc(&func_arena, 2 * cfg.count * sizeof(int));
+    int  sp    = 0;
+    int  post  = cfg.count;     // fill rpo from the back as blocks finish
+
+    // rpo_num marks blocks as seen while the search runs
+    cfg.rpo_num[0] = 0;
+    stack[sp++] = 0;
+    stack[sp++] = 0;
+    while (sp > 0) {
+        int b = stack[sp - 2];
+        int k = stack[sp - 1];
+        if (k < 2) {
+            stack[sp - 1]++;
+            int s = cfg.block[b].succ[k];
+            if (s >= 0 && cfg.rpo_num[s] < 0) {
+                cfg.rpo_num[s] = 0;
+                stack[sp++] = s;
+                stack[sp++] = 0;
+            }
+        } else {
+            cfg.rpo[--post] = b;
+            sp -= 2;
+        }
+    }
+
+    // move the order to the front of rpo and number it
+    cfg.num_rpo = cfg.count - post;
+    memmove(cfg.rpo, cfg.rpo + post, cfg.num_rpo * sizeof(int));
+    for (int i = 0; i < cfg.num_rpo; i++) cfg.rpo_num[cfg.rpo[i]] = i;
+}
+
+// the nearest block that dominates both a and b, walking up the idoms
+// of whichever is later in reverse postorder
+static int common_dominator(int a, int b) {
+    while (a != b) {
+        while (cfg.rpo_num[a] > cfg.rpo_num[b]) a = cfg.idom[a];
+        while (cfg.rpo_num[b] > cfg.rpo_num[a]) b = cfg.idom[b];
+    } return a;
+}
+
+// find the immediate dominator of each block of the current cfg: the
+// last block every path from the entry to it goes through.  The entry is
+// its own, and a block that can't be reached has -1.
+// iterates over the blocks in reverse postorder until nothing changes
+// (Cooper, Harvey and Kennedy), which for code without irreducible
+// loops takes a couple of passes
+void find_dominators() {
+    cfg.idom = (int *)arena_alloc(&func_arena, (cfg.count + 1) * sizeof(int));
+    for (int b = 0; b < cfg.count; b++) cfg.idom[b] = -1;
+    if (cfg.count == 0) return;
+
+    cfg.idom[0] = 0;
+    for (int changed = 1; changed; ) {
+        changed = 0;
+        for (int i = 1; i < cfg.num_rpo; i++) {
+            Block *block = &cfg.block[cfg.rpo[i]];
+            int idom = -1;
+            for (int k = 0; k < block->num_pred; k++) {
+                int p = block->pred[k];
+                if (cfg.idom[p] < 0) continue;
+                idom = idom < 0 ? p : common_dominator(p, idom);
+            }
+
+            if (idom != cfg.idom[cfg.rpo[i]]) {
+                cfg.idom[cfg.rpo[i]] = idom;
+                changed = 1;
+            }
+        }
+    }
+}
+
+// build the blocks of ir, freed with the rest of the function
+void build_cfg() {
+    // labels are numbered across the whole program, so only
+    // map the range this function uses
+    int lo = INT_MAX, hi = INT_MIN;
+    for (int i = 0; i < ir.count; i++) {
+        if (ir.instr[i].op != OP_LABEL) continue;
+        int label = OPND_INT(ir.instr[i].dest);
+        if (label < lo) lo = label;
+        if (label > hi) hi = label;
+    }
+
+    cfg.lbl_base  = lo;
+    cfg.lbl_count = hi >= lo ? hi - lo + 1 : 0;
+    cfg.lbl_block = (int *)arena_alloc(&func_arena, cfg.lbl_count * sizeof(int));
+    for (int i = 0; i < cfg.lbl_count; i++) cfg.lbl_block[i] = -1;
+
+    // a block starts at the top, at each label, and after each jump
+    cfg.block = (Block *)arena_alloc(&func_arena, (ir.count + 1) * sizeof(Block));
+    cfg.count = 0;
+    for (int i = 0; i < ir.count; i++) {
+        Instr *instr = &ir.instr[i];
+        if (i == 0 || instr->op == OP_LABEL || ends_block(ir.instr[i - 1].op)) {
+            if (cfg.count > 0) cfg.block[cfg.count - 1].end = i;
+            cfg.block[cfg.count++].first = i;
+        }
+
+        if (instr->op == OP_LABEL) {
+            cfg.lbl_block[OPND_INT(instr->dest) - lo] = cfg.count - 1;
+        }
+    } if (cfg.count > 0) cfg.block[cfg.count - 1].end = ir.count;
+
+    // where control goes after each block
+    for (int b = 0; b < cfg.count; b++) {
+        Block *block = &cfg.block[b];
+        Instr *last  = &ir.instr[block->end - 1];
+        int    next  = b + 1 < cfg.count ? b + 1 : -1;
+
+        block->succ[0] = -1;
+        block->succ[1] = -1;
+        if (last->op == OP_GOTO) {
+            block->succ[1] = label_block(OPND_INT(last->dest));
+        } else if (is_cond_branch(last->op)) {
+            block->succ[0] = next;
+            block->succ[1] = label_block(OPND_INT(last->dest));
+        } else if (last->op != OP_RETURN) {
+            block->succ[0] = next;
+        }
+    }
+
+    find_preds();
+    find_rpo();
+}
@@ -0,0 +1,43 @@
+/*
+ * File: cfg.h
+ * Author: Maria Fay Garcia
+ * Purpose: To outline the control flow graph of the function
+ *          being compiled: its basic blocks and the edges between them
+ */
+#ifndef __CFG_H__
+#define __CFG_H__
+
+#include "code_gen.h"
+
+// a run of ir that is only entered at the top and only left at the bottom
+typedef struct {
+    int      first;     // the block is ir.instr[first..end)
+    int      end;
+    int      succ[2];   // the fall through and the jump target, -1 if none
+    int     *pred;      // the blocks that may come right before it
+    int      num_pred;
+} Block;
+
+typedef struct {
+    Block   *block;     // in the order they are laid out, block 0 is the entry
+    int      count;
+    int     *rpo;       // the blocks reachable from the entry, in reverse postorder
+    int      num_rpo;
+    int     *rpo_num;   // each block's place in rpo, -1 if it can't be reached
+    int     *idom;      // each block's immediate dominator, see find_dominators
+    int     *lbl_block; // the block each label of the function starts
+    int      lbl_base;  // the lowest label of the function
+    int      lbl_count;
+} CFG;
+
+// the control flow graph of ir, as of the last build_cfg
+extern CFG cfg;
+
+// function stubs
+void     build_cfg       (                  );
+void     find_dominators (                  );
+int      ends_block      (OpType          op);
+int      is_cond_branch  (OpType          op);
+int      label_block     (int          label);
+
+#endif  /* __CFG_H__ */
@@ -1,12 +1,37 @@
 #include "code_gen.h"
-
-#define BUFSZ 32
+#include "arena.h"
+#include "pass.h"
+#include "regalloc.h"
+#include "select.h"
+#include "asm.h"
+
+// the code and place of each node of the function being compiled
+// indexed by NodeId, only around while gen_mips_code runs
+// code_head/code_tail index gen_buf, 0 for no code
+typedef struct {
+    int           code_head;
+    int           code_tail;
+    Operand       place;
+    int           need;         // the temps it needs at once, see su_need
+    int           has_call;     // whether a call is under it
+} NodeCode;
+
+static NodeCode *node_code;
+
+// the instrs made while lowering, linked per node, reused for every function
+// instr[0] is never used, so 0 can end a list
+static InstrBuf gen_buf;
+
+// the code of the function, in order
+InstrBuf ir;
 
 // keep track of the current tmp and label,
 // so that these numbers do not conflict
 int tmp_num = 0;
 int lbl_num = 0;
 
+int frame_locals = 0;
+
 /*
  * an array of strings that gives, for each operand type,
  * a string indicating the corresponding three-address instruction
@@ -32,130 +57,266 @@ char *op_name[] = {
     "call",
     "return",
     "set_retval",
-    "get_retval"
+    "get_retval",
+    "nop"
 };
 
-// recursively generate the three address code for this function
-void gen_three_addr_code(ASTNode *root, int trueDst, int falseDst) {
-    if (!root) return;
-    switch (root->type) {
-        case FUNC_DEF:
-        {
+/*
+ * The lowering walks the tree with an explicit stack of frames instead
+ * of recursing, so long statement lists and deep expressions only cost
+ * heap.  A frame is visited once before its children (to make the labels
+ * they jump to), once per child, and once after the children (to emit
+ * its own code).  Labels and temps are made in the same order as a
+ * recursive walk would make them.
+ *
+ * A condition is given the label it jumps to when it holds, the one for
+ * when it does not, and the one its code is followed by (fallDst), so
+ * it only branches to the other one.
+ */
+typedef struct {
+    NodeId node;
+    int    trueDst;
+    int    falseDst;
+    int    fallDst;
+    int    step;        // the number of children pushed so far
+    int    lbl[3];      // labels made before the children
+} GenFrame;
+
+static GenFrame *gen_stack = NULL;
+static int       gen_cap   = 0;
+
+// make the labels the children of this node need
+static void gen_before(GenFrame *fr) {
+    ASTNode *node = AST(fr->node);
+    switch (node->type) {
+        case IF:
+            // then, else, after
+            fr->lbl[0] = new_label();
+            fr->lbl[1] = new_label();
+            fr->lbl[2] = new_label();
+            break;
+        case WHILE:
+            // test, body, after
+            fr->lbl[0] = new_label();
+            fr->lbl[1] = new_label();
+            fr->lbl[2] = new_label();
+            break;
+        case AND:
+        case OR:
+            // between the two operands
+            fr->lbl[0] = new_label();
+            break;
+        default:
+            break;
+    }
+}
 
-            // recursively generate the code for the function body
+// the next child of this node to generate code for, and its jump targets
+// returns 0 once every child is done
+static int gen_next_child(GenFrame *fr, NodeId *child, int *trueDst, int *falseDst, int *fallDst) {
+    ASTNode *node = AST(fr->node);
+    int step = fr->step;
+    *trueDst  = -1;
+    *falseDst = -1;
+    *fallDst  = -1;
+
+    switch (node->type) {
+        case FUNC_DEF:
             // skip child 0, as it is just declarations
-            gen_three_addr_code(root->child1, -1, -1);
+            if (step > 0) return 0;
+            *child = node->child1;
+            return 1;
+        case FUNC_CALL:
+        case ASSG:
+        case RETURN:
+        case UMINUS:
+            if (step > 0) return 0;
+            *child = node->child0;
+            return 1;
+        case IF:
+            if (step > 2) return 0;
+            *child = step == 0 ? node->child0 : step == 1 ? node->child1 : node->child2;
+            if (step == 0) {
+                // for bool expr -- pass true/false labels
+                // with no else, false goes straight to after
+                // the then block comes next
+                *trueDst  = fr->lbl[0];
+                *falseDst = node->child2 ? fr->lbl[1] : fr->lbl[2];
+                *fallDst  = fr->lbl[0];
+            } return 1;
+        case WHILE:
+            if (step > 1) return 0;
+            *child = step == 0 ? node->child0 : node->child1;
+            if (step == 0) {
+                // bool expr -- pass true/false labels
+                // the test is at the bottom, the loop is left below it
+                *trueDst  = fr->lbl[1];
+                *falseDst = fr->lbl[2];
+                *fallDst  = fr->lbl[2];
+            } return 1;
+        case AND:
+        case OR:
+            if (step > 1) return 0;
+            *child = step == 0 ? node->child0 : node->child1;
+            *trueDst  = fr->trueDst;
+            *falseDst = fr->falseDst;
+            *fallDst  = fr->fallDst;
+            if (step == 0) *fallDst = fr->lbl[0];
+            if (step == 0 && node->type == AND) *trueDst  = fr->lbl[0];
+            if (step == 0 && node->type == OR)  *falseDst = fr->lbl[0];
+            return 1;
+        case STMT_LIST:
+        case EXPR_LIST:
+        case EQ:
+        case NE:
+        case LT:
+        case LE:
+        case GT:
+        case GE:
+        case ADD:
+        case SUB:
+        case MUL:
+        case DIV:
+            if (step > 1) return 0;
+            *child = step == 0 ? node->child0 : node->child1;
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/*
+ * Sethi-Ullman: the temps needed to have both operands of a node at
+ * once, if the operand needing more is worked out first.  Variables and
+ * constants are operands as they are, so they need none.
+ */
+static int su_need(int left, int right) {
+    if (left == right) return left ? left + 1 : 0;
+    return left > right ? left : right;
+}
+
+// put the code of the operands of root in dest's code, the one needing
+// more temps first; a call may read or set what the other reads, so
+// operands with calls under them are left in order
+static void concat_operands(NodeId root, NodeId left, NodeId right) {
+    NodeCode *l = &node_code[left];
+    NodeCode *r = &node_code[right];
+    if (r->need > l->need && !l->has_call && !r->has_call) {
+        concat_code(root, right);
+        concat_code(root, left);
+    } else {
+        concat_code(root, left);
+        concat_code(root, right);
+    }
+}
+
+// generate the code for this node, once its children have theirs
+static void gen_after(GenFrame *fr) {
+    NodeId root = fr->node;
+    ASTNode *node = AST(root);
+    int trueDst  = fr->trueDst;
+    int falseDst = fr->falseDst;
+    int fallDst  = fr->fallDst;
 
+    node_code[root].has_call = node->type == FUNC_CALL
+                            || node_code[node->child0].has_call
+                            || node_code[node->child1].has_call;
+
+    switch (node->type) {
+        case FUNC_DEF:
+        {
             /*
              * dest  - operand f, the function being defined
              * enter - enter instruction
              * leave - leave instruction
              * return - return instruction
              */
-            Operand *dest = new_operand(STPTR, (void *)root->symtab_entry);
-            Instr *enter = new_instr(OP_ENTER, NULL, NULL, dest);
-            Instr *leave = new_instr(OP_LEAVE, NULL, NULL, dest);
-            Instr *ret   = new_instr(OP_RETURN, NULL, NULL, dest);
+            Operand dest = new_operand(STPTR, (void *)NODE_ENTRY(node));
+            int enter = new_instr(OP_ENTER, NO_OPERAND, NO_OPERAND, dest);
+            int leave = new_instr(OP_LEAVE, NO_OPERAND, NO_OPERAND, dest);
+            int ret   = new_instr(OP_RETURN, NO_OPERAND, NO_OPERAND, dest);
 
 
             // concatenate the three address code
             append_instr(root, enter);
-            concat_code(root, root->child1);
+            concat_code(root, node->child1);
             append_instr(root, leave);
             append_instr(root, ret);
 
-            // reset the tmp and lbl counters
-            tmp_num = 0;
             break;
 
         }
         case FUNC_CALL:
         {
-
-            // recursively generate the expr list code (params)
-            gen_three_addr_code(root->child0, -1, -1);
-
-            // concat the code
-            concat_code(root, root->child0);
+            // concat the code for the expr list (params)
+            concat_code(root, node->child0);
 
             // generate the param instructions, and add them to the code
-            gen_param_instr(root, root->child0);
+            gen_param_instr(root, node->child0);
 
             /*
              * src1 - func begin called
              * src2 - num of args passed to func
              * call - call instruction
              */
-            Operand *src1 = new_operand(STPTR, root->symtab_entry);
-            Operand *src2 = new_operand(ICONST, (void *)&root->symtab_entry->num_args);
-            Instr *call = new_instr(OP_CALL, src1, src2, NULL);
+            Operand src1 = new_operand(STPTR, NODE_ENTRY(node));
+            Operand src2 = new_operand(ICONST, (void *)&NODE_ENTRY(node)->num_args);
+            int call = new_instr(OP_CALL, src1, src2, NO_OPERAND);
 
             // concatenate the call code
             append_instr(root, call);
 
             // retrieve the return value
-            symtab_entry *temp = new_temp();
-            Operand *dest = new_operand(STPTR, (void *)temp);
-            Instr *retrieve = new_instr(OP_GET_RETVAL, NULL, NULL, dest);
+            Operand dest = new_temp();
+            int retrieve = new_instr(OP_GET_RETVAL, NO_OPERAND, NO_OPERAND, dest);
 
             // concatenate the retrieve instruction
             append_instr(root, retrieve);
 
             // update place to place of ret val
-            root->place = temp;
+            node_code[root].place = dest;
+            node_code[root].need  = node_code[node->child0].need > 1 ? node_code[node->child0].need : 1;
             break;
         }
         case IF:
         {
             /* LABEL TOMFOOLERY */
 
-            // generate trueDst stuff (then)
-            int true_lbl_num = new_label();
-            Operand *true_dest = new_operand(LABEL, (void *)&true_lbl_num);
-            Instr *true_lbl_instr = new_instr(OP_LABEL, NULL, NULL, true_dest);
-
-            // generate falseDst stuff (else)
-            int false_lbl_num = new_label();
-            Operand *false_dest = new_operand(LABEL, (void *)&false_lbl_num);
-            Instr *false_lbl_instr = new_instr(OP_LABEL, NULL, NULL, false_dest);
+            // trueDst stuff (then)
+            Operand true_dest = new_operand(LABEL, (void *)&fr->lbl[0]);
+            int true_lbl_instr = new_instr(OP_LABEL, NO_OPERAND, NO_OPERAND, true_dest);
 
-            // generate after stuff
-            int after_lbl_num = new_label();
-            Operand *after_dest = new_operand(LABEL, (void *)&after_lbl_num);
-            Instr *after_lbl_instr = new_instr(OP_LABEL, NULL, NULL, after_dest);
-            Instr *jump_after = new_instr(OP_GOTO, NULL, NULL, after_dest);
+            // falseDst stuff (else)
+            Operand false_dest = new_operand(LABEL, (void *)&fr->lbl[1]);
+            int false_lbl_instr = new_instr(OP_LABEL, NO_OPERAND, NO_OPERAND, false_dest);
 
-            /* CODE GENERATION */
-
-            // for bool expr -- pass true/false labels
-            gen_three_addr_code(root->child0, true_lbl_num, false_lbl_num);
-
-            // then block
-            gen_three_addr_code(root->child1, -1, -1);
-
-            // else block
-            gen_three_addr_code(root->child2, -1, -1);
+            // after stuff
+            Operand after_dest = new_operand(LABEL, (void *)&fr->lbl[2]);
+            int after_lbl_instr = new_instr(OP_LABEL, NO_OPERAND, NO_OPERAND, after_dest);
+            int jump_after = new_instr(OP_GOTO, NO_OPERAND, NO_OPERAND, after_dest);
 
 
             /* CONCATENATION */
 
             // bool expr
-            concat_code(root, root->child0);
+            concat_code(root, node->child0);
 
             // label instr for true (then)
             append_instr(root, true_lbl_instr);
 
             // then block
-            concat_code(root, root->child1);
+            concat_code(root, node->child1);
 
-            // append jump after instr
-            append_instr(root, jump_after);
+            if (node->child2) {
+                // append jump after instr
+                append_instr(root, jump_after);
 
-            // label instr for false (else)
-            append_instr(root, false_lbl_instr);
+                // label instr for false (else)
+                append_instr(root, false_lbl_instr);
 
-            // concat the code for the else body
-            concat_code(root, root->child2);
+                // concat the code for the else body
+                concat_code(root, node->child2);
+            }
 
             // append the label instr for after the else block
             append_instr(root, after_lbl_instr);
@@ -165,48 +326,37 @@ void gen_three_addr_code(ASTNode *root, int trueDst, int falseDst) {
         {
             /* LABEL TOMFOOLERY */
 
-            // generate top stuff
-            int top_lbl_num = new_label();
-            Operand *top_dest = new_operand(LABEL, (void *)&top_lbl_num);
-            Instr *top_lbl_instr = new_instr(OP_LABEL, NULL, NULL, top_dest);
-            Instr *jump_top = new_instr(OP_GOTO, NULL, NULL, top_dest);
-
-            // generate trueDst stuff (body)
-            int true_lbl_num = new_label();
-            Operand *true_dest = new_operand(LABEL, (void *)&true_lbl_num);
-            Instr *true_lbl_instr = new_instr(OP_LABEL, NULL, NULL, true_dest);
-
-            // generate falseDst stuff (after)
-            int false_lbl_num = new_label();
-            Operand *false_dest = new_operand(LABEL, (void *)&false_lbl_num);
-            Instr *false_lbl_instr = new_instr(OP_LABEL, NULL, NULL, false_dest);
+            // test stuff
+            Operand test_dest = new_operand(LABEL, (void *)&fr->lbl[0]);
+            int test_lbl_instr = new_instr(OP_LABEL, NO_OPERAND, NO_OPERAND, test_dest);
+            int jump_test = new_instr(OP_GOTO, NO_OPERAND, NO_OPERAND, test_dest);
 
+            // trueDst stuff (body)
+            Operand true_dest = new_operand(LABEL, (void *)&fr->lbl[1]);
+            int true_lbl_instr = new_instr(OP_LABEL, NO_OPERAND, NO_OPERAND, true_dest);
 
-            /* CODE GENERATION */
-
-            // bool expr -- pass true/false labels
-            gen_three_addr_code(root->child0, true_lbl_num, false_lbl_num);
-
-            // body
-            gen_three_addr_code(root->child1, -1, -1);
+            // falseDst stuff (after)
+            Operand false_dest = new_operand(LABEL, (void *)&fr->lbl[2]);
+            int false_lbl_instr = new_instr(OP_LABEL, NO_OPERAND, NO_OPERAND, false_dest);
 
             
             /* CONCATENATION */
 
-            // top label
-            append_instr(root, top_lbl_instr);
-
-            // bool expr
-            concat_code(root, root->child0);
+            // the test is at the bottom, so each time around takes
+            // one branch: jump to it the first time
+            append_instr(root, jump_test);
 
             // body label
             append_instr(root, true_lbl_instr);
 
             // body code
-            concat_code(root, root->child1);
+            concat_code(root, node->child1);
 
-            // jump to top
-            append_instr(root, jump_top);
+            // test label
+            append_instr(root, test_lbl_instr);
+
+            // bool expr
+            concat_code(root, node->child0);
 
             // after label
             append_instr(root, false_lbl_instr);
@@ -217,9 +367,7 @@ void gen_three_addr_code(ASTNode *root, int trueDst, int falseDst) {
         {
             // 1. LHS evaluation is trivial because it is always an id
             //      thus code is NULL
-            // 2. evaluate RHS
-            // should implicitly generate a new tmp variable
-            gen_three_addr_code(root->child0, -1, -1);
+            // 2. the RHS has been evaluated into a tmp variable
 
             // 3. generate instruction
             /*
@@ -228,102 +376,80 @@ void gen_three_addr_code(ASTNode *root, int trueDst, int falseDst) {
              *        ...the place of the child should implicitly be where temp is
              * assg - the assignment instruction
              */
-            Operand *dest = new_operand(STPTR, root->symtab_entry);
-            Operand *src1 = new_operand(STPTR, root->child0->place);
-            Instr *assg = new_instr(OP_ASSG, src1, NULL, dest);
+            Operand dest = new_operand(STPTR, NODE_ENTRY(node));
+            Operand src1 = node_code[node->child0].place;
+            int assg = new_instr(OP_ASSG, src1, NO_OPERAND, dest);
 
             // 4. concatenate the three address code
-            concat_code(root, root->child0);
+            concat_code(root, node->child0);
             append_instr(root, assg);
             break;
         }
         case RETURN:
         {
-            // generate the code for the body of the return statement
-            gen_three_addr_code(root->child0, -1, -1);
-
-            // concat the code
-            concat_code(root, root->child0);
+            // concat the code for the body of the return statement
+            concat_code(root, node->child0);
 
             // move the place up
-            if (root->child0) root->place = root->child0->place;
+            if (node->child0) {
+                node_code[root].place = node_code[node->child0].place;
 
-            // create and append retval instruction
-            Operand *src = new_operand(STPTR, (void *)root->place);
-            Instr *set_retval_instr = new_instr(OP_SET_RETVAL, src, NULL, NULL);
-            append_instr(root, set_retval_instr);
+                // create and append retval instruction
+                Operand src = node_code[root].place;
+                int set_retval_instr = new_instr(OP_SET_RETVAL, src, NO_OPERAND, NO_OPERAND);
+                append_instr(root, set_retval_instr);
+            }
 
             // create and append leave instruction
-            Instr *leave_instr = new_instr(OP_LEAVE, NULL, NULL, NULL);
+            int leave_instr = new_instr(OP_LEAVE, NO_OPERAND, NO_OPERAND, NO_OPERAND);
             append_instr(root, leave_instr);
             
             // create and append return instruction
-            Instr *ret_instr = new_instr(OP_RETURN, NULL, NULL, NULL);
+            int ret_instr = new_instr(OP_RETURN, NO_OPERAND, NO_OPERAND, NO_OPERAND);
             append_instr(root, ret_instr);
 
             break;
         }
         case STMT_LIST:
         {
-            // recursively generate the code for the statement
-            gen_three_addr_code(root->child0, -1, -1);
-
-            // recursively generate the code for the rest of the stmt list
-            gen_three_addr_code(root->child1, -1, -1);
-
             // concatenate the three address code together
-            concat_code(root, root->child0);
-            concat_code(root, root->child1);
+            concat_code(root, node->child0);
+            concat_code(root, node->child1);
 
             break;
         }
         case EXPR_LIST:
         {
-            // recursively generate the code for the arith_exp
-            gen_three_addr_code(root->child0, -1, -1);
-
-            // recursively generate the code for the rest of the expr list
-            gen_three_addr_code(root->child1, -1, -1);
-
             // concatenate the three address code together
-            concat_code(root, root->child0);
-            concat_code(root, root->child1);
+            concat_code(root, node->child0);
+            concat_code(root, node->child1);
+
+            node_code[root].place = node_code[node->child0].place;
 
-            root->place = root->child0->place;
+            // each arg is held while the ones after it are worked out
+            NodeCode *arg  = &node_code[node->child0];
+            NodeCode *rest = &node_code[node->child1];
+            int need = (arg->need > 0) + rest->need;
+            node_code[root].need = arg->need > need ? arg->need : need;
             break;
         }
         case IDENTIFIER:
         {
             // code: NULL
             // place: symtab_entry
-            root->place = root->symtab_entry;
+            node_code[root].place = new_operand(STPTR, (void *)NODE_ENTRY(node));
             break;
 
         }
         case INTCONST:
         {
-            // code: tmp = intcon
-            // place: tmp's place in symbol table
-            
-            // get a new tmp var
-            // put it in symbol table
-            symtab_entry *tmp_stptr = new_temp();
-
-            /*
-             * tmp - destination operand
-             * intconst - source operand
-             * instr - assignment instruction
-             */
-            Operand *tmp = new_operand(STPTR, (void *)tmp_stptr);
-            Operand *intconst = new_operand(ICONST, (void *)&root->intcon);
-            Instr *instr = new_instr(OP_ASSG, intconst, NULL, tmp);
-
-            // add code, place to root
-            append_instr(root, instr);
-            root->place = tmp_stptr;
+            // code: NULL
+            // place: the constant itself, it is put into an
+            //        instruction's immediate field when translated
+            node_code[root].place = new_operand(ICONST, (void *)&node->intcon);
             break;
         }
-        // swap the bool in the three-addr code gen, so translation to mips is simple
+        // branch to the target the code is not followed by
         case EQ:
         case NE:
         case LT:
@@ -332,24 +458,14 @@ void gen_three_addr_code(ASTNode *root, int trueDst, int falseDst) {
         case GE:
         {
             // create label operands
-            Operand *true_dest = new_operand(LABEL, (void *)&trueDst);
-            Operand *false_dest = new_operand(LABEL, (void *)&falseDst);
-
-            /* CODE GENERATION */
-
-            // LHS
-            gen_three_addr_code(root->child0, -1, -1);
-
-            // RHS
-            gen_three_addr_code(root->child1, -1, -1);
+            Operand true_dest = new_operand(LABEL, (void *)&trueDst);
+            Operand false_dest = new_operand(LABEL, (void *)&falseDst);
 
             /* CONCATENATION */
-            
-            // LHS
-            concat_code(root, root->child0);
 
-            // RHS
-            concat_code(root, root->child1);
+            // LHS and RHS
+            concat_operands(root, node->child0, node->child1);
+            node_code[root].need = su_need(node_code[node->child0].need, node_code[node->child1].need);
 
 
             /*
@@ -357,22 +473,24 @@ void gen_three_addr_code(ASTNode *root, int trueDst, int falseDst) {
              * src2 - RHS
              * type - the OpType (based on NodeType)
              */
-            Operand *src1 = new_operand(STPTR, (void *)root->child0->place);
-            Operand *src2 = new_operand(STPTR, (void *)root->child1->place);
-            OpType op_type = get_opposite_type(root->type);
-
-
-            // generate comparison instr, jump to false if true (opposite)
-            Instr *comp_instr = new_instr(op_type, src1, src2, false_dest);
+            Operand src1 = node_code[node->child0].place;
+            Operand src2 = node_code[node->child1].place;
 
-            // jump to true if we get here
-            Instr *jump_true = new_instr(OP_GOTO, NULL, NULL, true_dest);
-
-            // append comparison instr
-            append_instr(root, comp_instr);
-
-            // append jump instr
-            append_instr(root, jump_true);
+            if (fallDst == trueDst) {
+                // falls into true: jump to false if the opposite holds
+                int comp_instr = new_instr(get_opposite_type(node->type), src1, src2, false_dest);
+                append_instr(root, comp_instr);
+            } else {
+                // jump to true if it holds
+                int comp_instr = new_instr(get_type(node->type), src1, src2, true_dest);
+                append_instr(root, comp_instr);
+
+                // and to false if not, unless false comes next
+                if (fallDst != falseDst) {
+                    int jump_false = new_instr(OP_GOTO, NO_OPERAND, NO_OPERAND, false_dest);
+                    append_instr(root, jump_false);
+                }
+            }
             break;
         }
         case ADD:
@@ -380,84 +498,62 @@ void gen_three_addr_code(ASTNode *root, int trueDst, int falseDst) {
         case MUL:
         case DIV:
         {
-            /* CODE GENERATION */
-            gen_three_addr_code(root->child0, -1, -1); // LHS
-            gen_three_addr_code(root->child1, -1, -1); // RHS
-
             /* CONCATENATION */
-            concat_code(root, root->child0); // LHS
-            concat_code(root, root->child1); // RHS
-
-            // create a new temp which will store the result of the expr
-            symtab_entry *temp = new_temp();
+            concat_operands(root, node->child0, node->child1); // LHS and RHS
 
             /*
              * src1 - LHS
              * src2 - RHS
-             * dest - place of root
+             * dest - place of root, a new temp which will store the result of the expr
              * type - the OpType (based on NodeType)
              */
-            Operand *src1 = new_operand(STPTR, (void *)root->child0->place);
-            Operand *src2 = new_operand(STPTR, (void *)root->child1->place);
-            Operand *dest = new_operand(STPTR, (void *)temp);
-            OpType op_type = get_type(root->type);
+            Operand src1 = node_code[node->child0].place;
+            Operand src2 = node_code[node->child1].place;
+            Operand dest = new_temp();
+            OpType op_type = get_type(node->type);
 
-            Instr *arith_instr = new_instr(op_type, src1, src2, dest);
+            int arith_instr = new_instr(op_type, src1, src2, dest);
 
             append_instr(root, arith_instr);
 
             // update place
-            root->place = temp;
+            int need = su_need(node_code[node->child0].need, node_code[node->child1].need);
+            node_code[root].place = dest;
+            node_code[root].need  = need > 1 ? need : 1;
             break;
         }
         case UMINUS:
         {
-            /* CODE GENERATION */
-            gen_three_addr_code(root->child0, -1, -1);
-
             /* CONCATENATION */
-            concat_code(root, root->child0);
+            concat_code(root, node->child0);
             
-            // create a new temp which will store the result of the expr
-            symtab_entry *temp = new_temp();
-
             /* 
              * src  - RHS
-             * dest - place of root
+             * dest - place of root, a new temp which will store the result of the expr
              */
-            Operand *src  = new_operand(STPTR, (void *)root->child0->place);
-            Operand *dest = new_operand(STPTR, (void *)temp);
+            Operand src  = node_code[node->child0].place;
+            Operand dest = new_temp();
 
-            Instr *unary_instr = new_instr(OP_UNARY_MINUS, src, NULL, dest);
+            int unary_instr = new_instr(OP_UNARY_MINUS, src, NO_OPERAND, dest);
 
             append_instr(root, unary_instr);
 
             // update place
-            root->place = temp;
+            node_code[root].place = dest;
+            node_code[root].need  = node_code[node->child0].need > 1 ? node_code[node->child0].need : 1;
             break;
         }
         case AND:
         case OR:
         {
-            /* LABEL TOMFOOLERY */
-
-            // make intermediate label
-            int int_lbl_num = new_label();
-            Operand *int_lbl_dest = new_operand(LABEL, (void *)&int_lbl_num);
-            Instr *jump_lbl_instr = new_instr(OP_LABEL, NULL, NULL, int_lbl_dest);
-
-            /* CODE GENERATION */
-            int trueDst_int  = root->type == AND ? int_lbl_num : trueDst;
-            int falseDst_int = root->type == AND ? falseDst : int_lbl_num;
-
-            gen_three_addr_code(root->child0, trueDst_int, falseDst_int);
-            gen_three_addr_code(root->child1, trueDst, falseDst);
-
+            // the intermediate label, between the operands
+            Operand int_lbl_dest = new_operand(LABEL, (void *)&fr->lbl[0]);
+            int jump_lbl_instr = new_instr(OP_LABEL, NO_OPERAND, NO_OPERAND, int_lbl_dest);
 
             /* CONCATENATION */
-            concat_code(root, root->child0);
+            concat_code(root, node->child0);
             append_instr(root, jump_lbl_instr);
-            concat_code(root, root->child1);
+            concat_code(root, node->child1);
             break;
         }
         default:
@@ -465,12 +561,56 @@ void gen_three_addr_code(ASTNode *root, int trueDst, int falseDst) {
     }
 }
 
-void gen_param_instr(ASTNode *concat_to, ASTNode *expr_head) {
-    if (expr_head) {
-        gen_param_instr(concat_to, expr_head->child1);
-        symtab_entry *param_stptr = expr_head->child0->place;
-        Operand *src = new_operand(STPTR, (void *)param_stptr);
-        Instr *param = new_instr(OP_PARAM, src, NULL, NULL);
+// push a frame for node onto the work stack
+static void gen_push(int *sp, NodeId node, int trueDst, int falseDst, int fallDst) {
+    if (*sp == gen_cap) {
+        gen_cap = gen_cap ? 2 * gen_cap : 256;
+        gen_stack = (GenFrame *)realloc(gen_stack, gen_cap * sizeof(GenFrame));
+    }
+
+    GenFrame *fr = &gen_stack[(*sp)++];
+    fr->node     = node;
+    fr->trueDst  = trueDst;
+    fr->falseDst = falseDst;
+    fr->fallDst  = fallDst;
+    fr->step     = 0;
+    gen_before(fr);
+}
+
+// generate the three address code for the tree at root
+void gen_three_addr_code(NodeId root, int trueDst, int falseDst) {
+    if (!root) return;
+
+    int sp = 0;
+    gen_push(&sp, root, trueDst, falseDst, -1);
+
+    while (sp > 0) {
+        GenFrame *fr = &gen_stack[sp - 1];
+        NodeId child;
+        int child_true, child_false, child_fall;
+
+        if (gen_next_child(fr, &child, &child_true, &child_false, &child_fall)) {
+            fr->step++;
+            if (child) gen_push(&sp, child, child_true, child_false, child_fall);
+        } else {
+            gen_after(fr);
+            sp--;
+        }
+    }
+}
+
+// append a param instr for each arg, the last one first
+void gen_param_instr(NodeId concat_to, NodeId expr_head) {
+    int num_args = count_num_args_passed(expr_head);
+    NodeId *args = (NodeId *)arena_alloc(&func_arena, num_args * sizeof(NodeId));
+    for (int i = 0; i < num_args; i++) {
+        args[i] = expr_head;
+        expr_head = AST(expr_head)->child1;
+    }
+
+    for (int i = num_args - 1; i >= 0; i--) {
+        Operand src = node_code[AST(args[i])->child0].place;
+        int param = new_instr(OP_PARAM, src, NO_OPERAND, NO_OPERAND);
         append_instr(concat_to, param);
     }
 }
@@ -485,6 +625,18 @@ OpType get_type(NodeType type) {
             return OP_MUL;
         case DIV:
             return OP_DIV;
+        case EQ:
+            return OP_EQ;
+        case NE:
+            return OP_NE;
+        case LT:
+            return OP_LT;
+        case LE:
+            return OP_LE;
+        case GT:
+            return OP_GT;
+        case GE:
+            return OP_GE;
         default:
             // dummy value, execution should never get to this point
             printf("you shouldn't be here...\n");
@@ -516,90 +668,121 @@ OpType get_opposite_type(NodeType type) {
 
 // generate a new operand
 // TODO: change to cast instead of dereference
-Operand *new_operand(OperandType operand_type, void *val) {
-    Operand *newop = (Operand *)calloc(1, sizeof(Operand));
-    newop->operand_type = operand_type;
+Operand new_operand(OperandType operand_type, void *val) {
     switch (operand_type) {
-        case ICONST:
-            newop->val.iconst = *((int *)val);
-            break;
         case STPTR:
-            newop->val.symtab_ptr = (symtab_entry *)val;
-            break;
+            return (Operand)(uintptr_t)val | STPTR;
+        case ICONST:
         case LABEL:
-            newop->val.label = *((int *)val);
-            break;
-    } return newop;
+        case TEMP:
+            return (Operand)(int64_t)*((int *)val) << OPND_TAG_BITS | operand_type;
+        default:
+            return NO_OPERAND;
+    }
 }
 
-// generate a new instruction
-Instr *new_instr(OpType op, Operand *src1, Operand *src2, Operand *dest) {
-    Instr *new_instr = (Instr *) calloc(1, sizeof(Instr));
-    new_instr->op = op;
+// generate a new instruction, at the end of gen_buf
+// returns its index, which stays valid when gen_buf grows
+int new_instr(OpType op, Operand src1, Operand src2, Operand dest) {
+    if (gen_buf.count >= gen_buf.cap) {
+        gen_buf.cap = gen_buf.cap ? 2 * gen_buf.cap : 1024;
+        gen_buf.instr = (Instr *)realloc(gen_buf.instr, gen_buf.cap * sizeof(Instr));
+    }
+
+    int i = gen_buf.count++;
+    Instr *new_instr = &gen_buf.instr[i];
+    new_instr->op   = op;
+    new_instr->next = 0;
     new_instr->src1 = src1;
     new_instr->src2 = src2;
     new_instr->dest = dest;
-    return new_instr;
+    return i;
 }
 
-// generate a new temporary variable
-// add it to the symbol table
-symtab_entry *new_temp() {
-    char *temp_buf = (char *)malloc(BUFSZ);
-    sprintf(temp_buf, "tmp%d", tmp_num++);
-    return add_entry(temp_buf, VAR);
+// generate a new temporary -- a virtual register, numbered per function
+// temps get their storage when the code is translated, see get_operand_loc
+Operand new_temp() {
+    int temp = tmp_num++;
+    return new_operand(TEMP, (void *)&temp);
 }
 
 // generate a new label
 int new_label() { return lbl_num++; }
 
 // concatenate the three address code from dest with that of src, store into dest
-void concat_code(ASTNode *dest, ASTNode *src) {
+void concat_code(NodeId dest_id, NodeId src_id) {
+    NodeCode *dest = &node_code[dest_id];
+    NodeCode *src  = &node_code[src_id];
+
     // check for valid src ast node
-    if (!dest->code_head && src) {
+    if (!dest->code_head && src_id) {
         // no code...
         // just copy head/tail ptrs from src
         dest->code_head = src->code_head;
         dest->code_tail = src->code_tail;
-    } else if (src && src->code_head) {
+    } else if (src_id && src->code_head) {
         // code exists...
-        // append and set pointers appropriately
-        dest->code_tail->next = src->code_head;
+        // link and set indices appropriately
+        gen_buf.instr[dest->code_tail].next = src->code_head;
         dest->code_tail = src->code_tail;
     }
 }
 
 // append a single instruction to the list of instructions for dest
 // works for empty list
-void append_instr(ASTNode *dest, Instr *instr) {
+void append_instr(NodeId dest_id, int instr) {
+    NodeCode *dest = &node_code[dest_id];
     if (!dest->code_head) {
         // no code exists...
-        // set head/tail ptrs
+        // set head/tail indices
         dest->code_head = instr;
         dest->code_tail = instr;
     } else {
         // code exists...
-        // append and modify tail ptr appropriately
-        dest->code_tail->next = instr;
-        dest->code_tail = dest->code_tail->next;
+        // link and modify tail index appropriately
+        gen_buf.instr[dest->code_tail].next = instr;
+        dest->code_tail = instr;
     }
 }
 
+// lay the code of root out in ir, in the order it runs
+// so later scans over the function go straight through memory
+void ir_linearize(NodeId root) {
+    if (ir.cap < gen_buf.count) {
+        ir.cap = gen_buf.cap;
+        ir.instr = (Instr *)realloc(ir.instr, ir.cap * sizeof(Instr));
+    }
+
+    ir.count = 0;
+    for (int i = node_code[root].code_head; i; i = gen_buf.instr[i].next) {
+        ir.instr[ir.count] = gen_buf.instr[i];
+        ir.instr[ir.count].next = 0;
+        ir.count++;
+    }
+}
+
+
+// drop the instrs a pass has turned into OP_NOP
+void ir_compact() {
+    int n = 0;
+    for (int i = 0; i < ir.count; i++) {
+        if (ir.instr[i].op != OP_NOP) ir.instr[n++] = ir.instr[i];
+    } ir.count = n;
+}
+
 
 // print the three address code for the entire function
 // as comments
-void print_three_addr_code(ASTNode *root) {
-    Instr *cur_instr = root->code_head;
-    while (cur_instr) {
-        print_three_addr_instr(cur_instr);
-        cur_instr = cur_instr->next;
+void print_three_addr_code() {
+    for (int i = 0; i < ir.count; i++) {
+        print_three_addr_instr(&ir.instr[i]);
     }
 }
 
 // print the three address code for a given instruction
 // as comments
 void print_three_addr_instr(Instr *instr) {
-    printf("# ");
+    emit("# ");
     switch (instr->op) {
         case OP_PLUS:
         case OP_MINUS:
@@ -609,26 +792,26 @@ void print_three_addr_instr(Instr *instr) {
             char *lhs  = get_val_string(instr->src1);
             char *rhs  = get_val_string(instr->src2);
             char *dest = get_val_string(instr->dest);
-            printf("%s := %s %s %s\n", dest, lhs, op_name[instr->op], rhs);
+            emit("%s := %s %s %s\n", dest, lhs, op_name[instr->op], rhs);
             break;
         }
         case OP_UNARY_MINUS: 
         {
             char *src  = get_val_string(instr->src1);
             char *dest = get_val_string(instr->dest);
-            printf("%s := -%s\n", dest, src);
+            emit("%s := -%s\n", dest, src);
             break;
         }
         case OP_ASSG:
         {
             char *lhs = get_val_string(instr->dest);
             char *rhs = get_val_string(instr->src1);
-            printf("%s %s %s\n", lhs, op_name[instr->op], rhs);
+            emit("%s %s %s\n", lhs, op_name[instr->op], rhs);
             break;
         }
         case OP_GOTO: {
             char *label = get_val_string(instr->dest);
-            printf("goto %s\n", label);
+            emit("goto %s\n", label);
             break;
         }
         case OP_EQ:
@@ -640,243 +823,187 @@ void print_three_addr_instr(Instr *instr) {
         {
             char *lhs = get_val_string(instr->src1);
             char *rhs = get_val_string(instr->src2);
-            printf("%s %s %s\n", lhs, op_name[instr->op], rhs);
+            emit("%s %s %s\n", lhs, op_name[instr->op], rhs);
             break;
         }
         case OP_LABEL:
         {
             char *label = get_val_string(instr->dest);
-            printf("label %s\n", label);
+            emit("label %s\n", label);
             break;
         }
         case OP_ENTER:
         {
             char *func = get_val_string(instr->dest);
-            printf("enter %s\n", func);
+            emit("enter %s\n", func);
             break;
         }
         case OP_LEAVE:
         {
-            printf("leave ");
-            if (instr->dest) {
+            emit("leave ");
+            if (instr->dest != NO_OPERAND) {
                 char *func = get_val_string(instr->dest);
-                printf("%s", func);
-            } printf("\n");
+                emit("%s", func);
+            } emit("\n");
             break;
         }
         case OP_PARAM:
         {
             char *id = get_val_string(instr->src1);
-            printf("param %s\n", id);
+            emit("param %s\n", id);
             break;
         }
         case OP_CALL:
         {
             char *func_name = get_val_string(instr->src1);
             char *num_args = get_val_string(instr->src2);
-            printf("call %s, %s\n", func_name, num_args);
+            emit("call %s, %s\n", func_name, num_args);
             break;
         }
         case OP_RETURN:
         {
-            printf("return\n");
+            emit("return\n");
             break;
         }
         case OP_SET_RETVAL:
         {
             char *src = get_val_string(instr->src1);
-            printf("set_retval %s\n", src);
+            emit("set_retval %s\n", src);
             break;
         }
         case OP_GET_RETVAL:
         {
             char *dest = get_val_string(instr->dest);
-            printf("get_retval %s\n", dest);
+            emit("get_retval %s\n", dest);
+            break;
+        }
+        case OP_NOP:
+        {
+            emit("nop\n");
             break;
         }
     }
 }
 
-char *get_val_string(Operand *op) {
-    char *val_buf = (char *)malloc(BUFSZ);
-    switch (op->operand_type) {
+char *get_val_string(Operand op) {
+    char *val_buf = NULL;
+    int   reg     = operand_reg(op);
+    switch (OPND_TYPE(op)) {
         case STPTR: {
-            symtab_entry *stptr = op->val.symtab_ptr;
+            symtab_entry *stptr = OPND_ENTRY(op);
             if (stptr->type == FUNC) {
-                sprintf(val_buf, "%s", stptr->lexeme);
+                val_buf = stptr->lexeme;
+            } else if (reg >= 0) {
+                val_buf = arena_sprintf(&func_arena, "%s [%s]", stptr->lexeme, reg_name[reg]);
             } else {
                 char *loc_string = get_loc_string(stptr);
-                sprintf(val_buf, "%s [%s]", stptr->lexeme, loc_string);
+                val_buf = arena_sprintf(&func_arena, "%s [%s]", stptr->lexeme, loc_string);
             }  break;
+        } case TEMP: {
+            char *loc = reg >= 0 ? reg_name[reg] : get_operand_loc(op);
+            val_buf = arena_sprintf(&func_arena, "tmp%d [%s]", OPND_INT(op), loc);
+            break;
         } case ICONST: {
-            sprintf(val_buf, "%d", op->val.iconst);
+            val_buf = arena_sprintf(&func_arena, "%d", OPND_INT(op));
             break;
         } case LABEL: {
-            sprintf(val_buf, "L%d", op->val.label);
-        }
+            val_buf = arena_sprintf(&func_arena, "L%d", OPND_INT(op));
+            break;
+        } default:
+            break;
     } return val_buf;
 }
 
-void make_symtab_offsets() {
-    symtab_entry *cur = symtab_hds[LOCAL];
-    int local_fp_offset = -4;
-    int param_fp_offset = 8;
-    while (cur) {
-        if (cur->type == VAR) {
-            if (cur->is_param) {
-                cur->fp_offset = param_fp_offset;
-                param_fp_offset += 4;
-            } else {
-                // local
-                cur->fp_offset = local_fp_offset;
-                local_fp_offset -= 4;
-            } 
-        } cur = cur->next;
-    }
-}
-
 // generate the mips code for the function
 // include the three address code as a comment
-void gen_mips_code(ASTNode* root) {
+void gen_mips_code(NodeId root) {
+    // one side table entry per node, freed with the rest of the function
+    node_code = (NodeCode *)arena_alloc(&func_arena, ast_count * sizeof(NodeCode));
+
+    // the temps are numbered from 0 in each function
+    tmp_num = 0;
+    frame_locals = symtabs[LOCAL].num_locals;
+    gen_buf.count = 1;
+
     // generate three address code
     gen_three_addr_code(root, -1, -1);
 
-    // make the symbol table offsets
-    make_symtab_offsets();
+    // the symbol table offsets are assigned as entries are added
+
+    // lay the code out in one array
+    ir_linearize(root);
+
+    // and improve it, the last pass gives out the registers
+    clear_registers();
+    run_passes();
+
+    // what a call to it changes, for the functions after it
+    record_clobbers();
 
     // print the three address code for the function
     // in comments above the corresponding mips code
-    // print_three_addr_code(root);
+    // print_three_addr_code();
 
     // translate each three address intruction to mips
-    Instr *cur_instr = root->code_head;
-    while (cur_instr) {
+    for (int i = 0; i < ir.count; i++) {
         // print each three address instruction in a comment above the corresponding mips code
-        print_three_addr_instr(cur_instr);
-        translate_three_addr_code(cur_instr);
-        cur_instr = cur_instr->next;
+        print_three_addr_instr(&ir.instr[i]);
+        translate_three_addr_code(&ir.instr[i]);
     }
+
+    // clean up the mips code and print it
+    run_asm_passes();
+    print_asm();
+}
+
+// the register holding the value of a source operand: $zero for the
+// constant 0, the register it was given, otherwise reg, loaded with li
+// (a constant, or a temp made again) or lw
+static char *load_operand(char *reg, Operand op) {
+    int val;
+    if (OPND_TYPE(op) == ICONST || remat_const(op, &val)) {
+        if (OPND_TYPE(op) == ICONST) val = OPND_INT(op);
+        if (val == 0) return "$zero";
+        emit("li %s, %d\n", reg, val);
+    } else if (operand_reg(op) >= 0) {
+        return reg_name[operand_reg(op)];
+    } else {
+        emit("lw %s, %s\n", reg, get_operand_loc(op));
+    } return reg;
+}
+
+// put the value computed in reg where dest lives
+// a temp made again where it is read is not kept at all
+static void store_dest(char *reg, Operand dest) {
+    int val;
+    if (operand_reg(dest) >= 0 || remat_const(dest, &val)) return;
+    emit("sw %s, %s\n", reg, get_operand_loc(dest));
+}
+
+// the slot the prologue saves the kth callee-saved register in,
+// below the locals and temps
+static char *saved_reg_loc(int k) {
+    return arena_sprintf(&func_arena, "%d($fp)", -4 * (frame_slots() + k + 1));
 }
 
 void translate_three_addr_code(Instr *instr) {
-    switch (instr->op) {
-        case OP_PLUS:
-        case OP_MINUS:
-        case OP_DIV:
-        case OP_MUL:
-        {
-            // unpack the operands
-            Operand *src1 = instr->src1;
-            Operand *src2 = instr->src2;
-            Operand *dest = instr->dest;
-
-            // get the loc strings
-            char *src1_loc_string = get_loc_string(src1->val.symtab_ptr);
-            char *src2_loc_string = get_loc_string(src2->val.symtab_ptr);
-            char *dest_loc_string = get_loc_string(dest->val.symtab_ptr);
-
-            printf(
-                    "lw $t0, %s\n"
-                    "lw $t1, %s\n"
-                    "%s $t2, $t0, $t1\n"
-                    "sw $t2, %s\n",
-                    src1_loc_string,
-                    src2_loc_string,
-                    op_name[instr->op],
-                    dest_loc_string
-                  );
-            printf("\n");
-            break;
-        }
-        case OP_UNARY_MINUS:
-        {
-            // unpack the operands
-            Operand *src  = instr->src1;
-            Operand *dest = instr->dest;
-
-            // get the loc strings
-            char *src_loc_string  = get_loc_string(src->val.symtab_ptr);
-            char *dest_loc_string = get_loc_string(dest->val.symtab_ptr);
-
-            printf(
-                    "lw $t0, %s\n"
-                    "neg $t1, $t0\n"
-                    "sw $t1, %s\n",
-                    src_loc_string,
-                    dest_loc_string
-                  );
-            printf("\n");
-            break;
-        }
-        case OP_ASSG:
-        {
-            // unpack the operands
-            /*
-             * src - either ICONST or VAR
-             * dest - always VAR
-             */
-            Operand *src = instr->src1;
-            Operand *dest = instr->dest;
-            
-            /*
-             * VAR: lw
-             * ICONST: li
-             */
-            switch (src->operand_type) {
-                case VAR: {
-                    char *src_loc_string = get_loc_string(src->val.symtab_ptr);
-                    printf("lw $t0, %s\n", src_loc_string);
-                    break;
-                } case ICONST:
-                    printf("li $t0, %d\n", src->val.iconst);
-                    break;
-                case LABEL:
-                    // should never be assigning to a label
-                    break;
-            }
+    // the arithmetic, copies and branches are covered by the rule table
+    if (select_instr(instr)) return;
 
-            char *dest_loc_string = get_loc_string(dest->val.symtab_ptr);
-            printf("sw $t0, %s\n", dest_loc_string);
-            printf("\n");
-            break;
-        }
+    switch (instr->op) {
         case OP_GOTO: {
-            Operand *dest = instr->dest;
-            int label = dest->val.label;
-            printf("j L%d\n", label);
-            printf("\n");
-            break;
-        }
-        case OP_EQ:
-        case OP_NE:
-        case OP_LT:
-        case OP_LE:
-        case OP_GT:
-        case OP_GE:
-        {
-            Operand *src1 = instr->src1;
-            Operand *src2 = instr->src2;
-            Operand *dest = instr->dest;
-            char *src1_loc_string = get_loc_string(src1->val.symtab_ptr);
-            char *src2_loc_string = get_loc_string(src2->val.symtab_ptr);
-            printf(
-                    "lw $t0, %s\n"
-                    "lw $t1, %s\n"
-                    "b%s $t0, $t1, L%d\n", 
-                    src1_loc_string,
-                    src2_loc_string,
-                    op_name[instr->op],
-                    dest->val.label
-                    );
-            printf("\n");
+            Operand dest = instr->dest;
+            int label = OPND_INT(dest);
+            emit("j L%d\n", label);
+            emit("\n");
             break;
         }
         case OP_LABEL:
         {
-            Operand *dest = instr->dest;
-            int label = dest->val.label;
-            printf("L%d:\n", label);
-            printf("\n");
+            Operand dest = instr->dest;
+            int label = OPND_INT(dest);
+            emit("L%d:\n", label);
+            emit("\n");
             break;
         }
         case OP_ENTER:
@@ -884,13 +1011,14 @@ void translate_three_addr_code(Instr *instr) {
             // generate function prologue
             
             // retrieve the name of the function
-            char *func = instr->dest->val.symtab_ptr->lexeme;
+            char *func = OPND_ENTRY(instr->dest)->lexeme;
 
-            // calculate the number of locals
-            int num_locals = get_num_locals();
+            // calculate the number of slots for the locals and temps,
+            // and each callee-saved register the function uses
+            int num_locals = frame_slots() + num_saved_regs;
             
             // write assembler directives
-            printf(
+            emit(
                     ".data\n"
                     ".align 2\n"
                     ".text\n"
@@ -904,56 +1032,69 @@ void translate_three_addr_code(Instr *instr) {
              * 4. update $fp to point into current stack frame
              * 5. allocate space for callee's locals and temps (not params)
              */
-            printf(
+            emit(
                     "_%s:\n"
                     "# PROLOGUE\n"
                     "la $sp, -8($sp)\n"
                     "sw $fp, 4($sp)\n"
                     "sw $ra, 0($sp)\n"
-                    "la $fp, 0($sp)\n"
-                    "la $sp, -%d($sp)\n",
-                    func,
-                    4*num_locals
+                    "la $fp, 0($sp)\n",
+                    func
                     );
-            printf("\n");
+            if (num_locals > 0) emit("la $sp, -%d($sp)\n", 4*num_locals);
+
+            /*
+             * 6. save the callee-saved registers the function uses
+             * 7. load the variables that come in in a register
+             */
+            for (int k = 0; k < num_saved_regs; k++) {
+                emit("sw %s, %s\n", reg_name[saved_regs[k]], saved_reg_loc(k));
+            }
+            for (int k = 0; k < num_entry_loads; k++) {
+                Operand var = new_operand(STPTR, entry_loads[k]);
+                emit("lw %s, %s\n", reg_name[operand_reg(var)], get_loc_string(entry_loads[k]));
+            }
+            emit("\n");
             break;
         }
         case OP_LEAVE:
         {
             // generate the function epilogue
             /*
-             * 1. deallocate locals
-             * 2. restore return address
-             * 3. restore frame pointer
-             * 4. restore stack pointer
-             * 5. return to caller
+             * 1. restore the callee-saved registers
+             * 2. deallocate locals
+             * 3. restore return address
+             * 4. restore frame pointer
+             * 5. restore stack pointer
+             * 6. return to caller
              */
-            printf(
-                    "# EPILOGUE\n"
+            emit("# EPILOGUE\n");
+            for (int k = 0; k < num_saved_regs; k++) {
+                emit("lw %s, %s\n", reg_name[saved_regs[k]], saved_reg_loc(k));
+            }
+            emit(
                     "la $sp, 0($fp)\n"
                     "lw $ra, 0($sp)\n"
                     "lw $fp, 4($sp)\n"
                     "la $sp, 8($sp)\n"
                   );
-            printf("\n");
+            emit("\n");
             break;
         }
         case OP_PARAM: {
 
-            char *loc_string = get_loc_string(instr->src1->val.symtab_ptr);
-
             /* 
              * 1. load param into temp
              * 2. decrement the stack pointer
              * 3. store param onto the stack
              */
-            printf(
-                    "lw $t0, %s\n"
+            char *src_reg = load_operand("$t0", instr->src1);
+            emit(
                     "la $sp, -4($sp)\n"
-                    "sw $t0, 0($sp)\n",
-                    loc_string
+                    "sw %s, 0($sp)\n",
+                    src_reg
                    );
-            printf("\n");
+            emit("\n");
             break;
         }
         case OP_CALL:
@@ -963,74 +1104,94 @@ void translate_three_addr_code(Instr *instr) {
             char *func = get_val_string(instr->src1);
             
             // retrieve number of arguments
-            int num_args = instr->src2->val.iconst;
+            int num_args = OPND_INT(instr->src2);
 
             /*
              * 1. jump and link to function
              * 2. increment stack pointer by 4*num_args
              */
-            printf(
+            emit(
                     "jal _%s\n"
                     "la $sp, %d($sp)\n",
                     func,
                     4*num_args
                   );
-            printf("\n");
+            emit("\n");
             break;
         }
         case OP_RETURN:
         {
             // generate return jump instruction
-            printf("jr $ra\n");
-            printf("\n");
+            emit("jr $ra\n");
+            emit("\n");
             break;
         }
         case OP_SET_RETVAL: {
-            char *src_loc_string = get_loc_string(instr->src1->val.symtab_ptr);
-            printf("lw $v0, %s\n", src_loc_string);
-            printf("\n");
+            Operand src = instr->src1;
+            int val;
+            if (OPND_TYPE(src) == ICONST) {
+                emit("li $v0, %d\n", OPND_INT(src));
+            } else if (remat_const(src, &val)) {
+                emit("li $v0, %d\n", val);
+            } else if (operand_reg(src) >= 0) {
+                emit("move $v0, %s\n", reg_name[operand_reg(src)]);
+            } else {
+                emit("lw $v0, %s\n", get_operand_loc(src));
+            }
+            emit("\n");
             break;
         }
         case OP_GET_RETVAL: {
             // TODO: this might cause bugs
-            char *dest_loc_string = get_loc_string(instr->dest->val.symtab_ptr);
-            printf("sw $v0, %s\n", dest_loc_string);
-            printf("\n");
+            Operand dest = instr->dest;
+            if (operand_reg(dest) >= 0) {
+                emit("move %s, $v0\n", reg_name[operand_reg(dest)]);
+            } else {
+                store_dest("$v0", dest);
+            }
+            emit("\n");
             break;
         }
+        case OP_NOP:
+            break;
+        default:
+            // selected by the rule table
+            break;
     }
 
 }
 
+// calculate the location of a variable or temp operand
+// temps are kept in the slots below the locals, see temp_slot
+char *get_operand_loc(Operand op) {
+    if (OPND_TYPE(op) == TEMP) {
+        return arena_sprintf(&func_arena, "%d($fp)", -4 * (temp_slot(OPND_INT(op)) + 1));
+    } return get_loc_string(OPND_ENTRY(op));
+}
+
 // calculate the location of the variable
 char *get_loc_string(symtab_entry *loc) {
-    char *loc_buf = (char *)malloc(BUFSZ);
+    char *loc_buf = NULL;
     switch (loc->scope) {
         case GLOBAL:
-            sprintf(loc_buf, "_%s", loc->lexeme);
+            loc_buf = arena_sprintf(&func_arena, "_%s", loc->lexeme);
             break;
         case LOCAL:
-            sprintf(loc_buf, "%d($fp)", loc->fp_offset);
+            loc_buf = arena_sprintf(&func_arena, "%d($fp)", loc->fp_offset);
             break;
     } return loc_buf;
 }
 
-// calculate the number of local variables
-// of a given local scope
+// the number of stack slots for local variables
 // exclude parameters
 int get_num_locals() {
-    int num_locs = 0;
-    symtab_entry* cur = symtab_hds[LOCAL];
-    while (cur) {
-        if (!cur->is_param) num_locs++;
-        cur = cur->next;
-    } return num_locs;
+    return frame_locals;
 }
 
 void dump_glob_symtab() {
     // for global variables, allocate space
     // don't do anything for functions
-    symtab_entry *cur = symtab_hds[GLOBAL];
+    symtab_entry *cur = symtabs[GLOBAL].head;
     printf(
             "# dumping global symbol table into mips\n"
             ".data\n"
@@ -7,16 +7,19 @@
 #ifndef __THREE_ADDR_H__
 #define __THREE_ADDR_H__
 
+#include <stdint.h>
 #include "symtab.h"
 
 extern Scope cur_scope;
-extern symtab_entry *symtab_hds[2];
+extern ScopeTable symtabs[2];
 
 // enums
 typedef enum {
+    NO_OPERAND,     // an unused operand slot
     ICONST,
     STPTR,
-    LABEL
+    LABEL,
+    TEMP            // a virtual register
 } OperandType;
 
 typedef enum {
@@ -40,50 +43,89 @@ typedef enum {
     OP_CALL,
     OP_RETURN,
     OP_SET_RETVAL,
-    OP_GET_RETVAL
+    OP_GET_RETVAL,
+    OP_NOP          // a removed instr, dropped by ir_compact
 } OpType;
 
 // structs
-typedef struct operand {
-    OperandType operand_type;
-    union {
-        int iconst;
-        symtab_entry *symtab_ptr;
-        int label;
-    } val;
-} Operand;
 
+/*
+ * An operand is one tagged 8-byte word, kept inline in its instruction:
+ * the OperandType in the low 3 bits, the value above them.  The value is
+ * an int (ICONST, LABEL, TEMP) shifted up, or a symtab_entry pointer
+ * (STPTR), whose low bits are free because entries are 8-byte aligned.
+ * Equal operands are equal words.
+ */
+typedef uint64_t Operand;
+
+#define OPND_TAG_BITS  3
+#define OPND_TAG_MASK  ((Operand)((1 << OPND_TAG_BITS) - 1))
+
+#define OPND_TYPE(o)   ((OperandType)((o) & OPND_TAG_MASK))
+#define OPND_INT(o)    ((int)((int64_t)(o) >> OPND_TAG_BITS))
+#define OPND_ENTRY(o)  ((symtab_entry *)(uintptr_t)((o) & ~OPND_TAG_MASK))
+
+/*
+ * The code of a function lives in one growable array of instructions.
+ * While it is being generated, the code of each node is a list threaded
+ * through next (an index, 0 ends the list); once the function is done
+ * the list is laid out in order, see ir_linearize.
+ */
 typedef struct instr {
-    OpType op;
-    Operand *src1;
-    Operand *src2;
-    Operand *dest;
-    struct instr *next;
+    OpType   op;
+    int      next;
+    Operand  src1;
+    Operand  src2;
+    Operand  dest;
 } Instr;
 
+typedef struct {
+    Instr   *instr;
+    int      count;
+    int      cap;
+} InstrBuf;
+
+// the code of the function being compiled, in order, once it is lowered
+extern InstrBuf ir;
+
+// the number of temps of the function being compiled
+extern int tmp_num;
+
+// the number of stack slots for its locals (not params), which the
+// optimizer lowers when it finds some unused
+extern int frame_locals;
+
+// the name of each operator of the three address code
+extern char *op_name[];
+
 // include ast.h for the type information
 #include "ast.h"
 
 // function stubs
-void gen_three_addr_code(ASTNode *root, int true_lbl, int false_lbl);
-void gen_param_instr(ASTNode *concat_to, ASTNode *expr_head);
+void gen_three_addr_code(NodeId root, int true_lbl, int false_lbl);
+void gen_param_instr(NodeId concat_to, NodeId expr_head);
 OpType get_type(NodeType type);
 OpType get_opposite_type(NodeType type);
-Operand *new_operand(OperandType operand_type, void *val);
-Instr *new_instr(OpType op, Operand *src1, Operand *src2, Operand *dest);
-symtab_entry *new_temp();
+Operand new_operand(OperandType operand_type, void *val);
+int new_instr(OpType op, Operand src1, Operand src2, Operand dest);
+Operand new_temp();
 int new_label();
-void concat_code(ASTNode *dest, ASTNode *src);
-void append_instr(ASTNode *dest, Instr *instr);
-void print_three_addr_code(ASTNode *root);
+void concat_code(NodeId dest, NodeId src);
+void append_instr(NodeId dest, int instr);
+void ir_linearize(NodeId root);
+void ir_compact();
+void print_three_addr_code();
 void print_three_addr_instr(Instr *instr);
-char *get_val_string(Operand *op);
-void make_symtab_offsets();
-void gen_mips_code(ASTNode* root);
+char *get_val_string(Operand op);
+void gen_mips_code(NodeId root);
 void translate_three_addr_code(Instr *instr);
 char *get_loc_string(symtab_entry *loc);
+char *get_operand_loc(Operand op);
 int get_num_locals();
 void dump_glob_symtab();
 void gen_println_and_main();
 
+// the registers the hand written println changes: $v0 and $a0
+#define PRINTLN_CLOBBERS ((1u << 2) | (1u << 4))
+
 #endif  /* __THREE_ADDR_H__ */
@@ -0,0 +1,185 @@
+/*
+ * File: dataflow.c
+ * Author: Maria Fay Garcia
+ * Purpose: An iterative solver for bit vector dataflow problems over the
+ *          blocks of the function being compiled, and the liveness
+ *          analysis built on it
+ */
+#include "dataflow.h"
+#include "opt.h"
+#include "arena.h"
+
+
+/*************** THE SOLVER *****************/
+
+// set up an empty problem over the current cfg, its sets freed with
+// the rest of the function
+// returns 0 if its sets would be larger than DF_MAX_WORDS
+int df_init(Dataflow *df, DFDirection dir, DFMeet meet, int num_bits) {
+    df->dir      = dir;
+    df->meet     = meet;
+    df->num_bits = num_bits;
+    df->words    = BIT_WORDS(num_bits);
+    df->visits   = 0;
+
+    size_t size = (size_t)cfg.count * df->words;
+    if (size > DF_MAX_WORDS) return 0;
+
+    df->gen  = (BitWord *)arena_alloc(&func_arena, (size + 1) * sizeof(BitWord));
+    df->kill = (BitWord *)arena_alloc(&func_arena, (size + 1) * sizeof(BitWord));
+    df->in   = (BitWord *)arena_alloc(&func_arena, (size + 1) * sizeof(BitWord));
+    df->out  = (BitWord *)arena_alloc(&func_arena, (size + 1) * sizeof(BitWord));
+    return 1;
+}
+
+/*
+ * The blocks that still need a visit are kept as a bit vector over their
+ * place in the order the problem runs in -- reverse postorder for a
+ * forward problem, postorder for a backward one -- and swept low to high.
+ * A block is visited after the ones before it in the order, so outside of
+ * loops every block is visited once, and a loop settles in a few sweeps.
+ */
+void df_solve(Dataflow *df) {
+    int n        = cfg.num_rpo;
+    int words    = df->words;
+    int forward  = df->dir == DF_FORWARD;
+    BitWord *to  = forward ? df->in  : df->out;     // what the meet makes
+    BitWord *res = forward ? df->out : df->in;      // what the block makes
+
+    // a must problem starts from everything holding, a may problem from nothing
+    if (df->meet == DF_INTERSECT) {
+        memset(res, 0xff, (size_t)cfg.count * words * sizeof(BitWord));
+    } else {
+        memset(res, 0, (size_t)cfg.count * words * sizeof(BitWord));
+    }
+
+    BitWord *pending = (BitWord *)arena_alloc(&func_arena, (BIT_WORDS(n) + 1) * sizeof(BitWord));
+    for (int i = 0; i < n; i++) BIT_SET(pending, i);
+
+    for (int any = 1; any; ) {
+        any = 0;
+        for (int w = 0; w < BIT_WORDS(n); w++) {
+            while (pending[w]) {
+                int i = w * 64 + __builtin_ctzll(pending[w]);
+                pending[w] &= pending[w] - 1;
+                any = 1;
+                df->visits++;
+
+                int b = cfg.rpo[forward ? i : n - 1 - i];
+                Block *block = &cfg.block[b];
+
+                // the meet over the blocks control comes from (forward)
+                // or goes to (backward); none is the boundary, empty
+                BitWord *meet = &to[(size_t)b * words];
+                int first = 1;
+                int num   = forward ? block->num_pred : 2;
+                for (int k = 0; k < num; k++) {
+                    int p = forward ? block->pred[k] : block->succ[k];
+                    if (p < 0 || cfg.rpo_num[p] < 0) continue;
+
+                    BitWord *from = &res[(size_t)p * words];
+                    if (first) {
+                        memcpy(meet, from, words * sizeof(BitWord));
+                        first = 0;
+                    } else if (df->meet == DF_UNION) {
+                        for (int x = 0; x < words; x++) meet[x] |= from[x];
+                    } else {
+                        for (int x = 0; x < words; x++) meet[x] &= from[x];
+                    }
+                } if (first) memset(meet, 0, words * sizeof(BitWord));
+
+                // the transfer through the block
+                BitWord *gen  = DF_SET(df, gen, b);
+                BitWord *kill = DF_SET(df, kill, b);
+                BitWord *r    = &res[(size_t)b * words];
+                BitWord  changed = 0;
+                for (int x = 0; x < words; x++) {
+                    BitWord v = gen[x] | (meet[x] & ~kill[x]);
+                    changed |= v ^ r[x];
+                    r[x] = v;
+                } if (!changed) continue;
+
+                // the blocks that depend on this one need another visit
+                num = forward ? 2 : block->num_pred;
+                for (int k = 0; k < num; k++) {
+                    int s = forward ? block->succ[k] : block->pred[k];
+                    if (s < 0 || cfg.rpo_num[s] < 0) continue;
+                    BIT_SET(pending, forward ? cfg.rpo_num[s] : n - 1 - cfg.rpo_num[s]);
+                }
+            }
+        }
+    }
+}
+
+
+/*************** DEFS AND USES *****************/
+
+// the variable instr sets for sure, -1 if none
+int instr_def(Instr *instr) {
+    switch (instr->op) {
+        case OP_PLUS:
+        case OP_MINUS:
+        case OP_MUL:
+        case OP_DIV:
+        case OP_UNARY_MINUS:
+        case OP_ASSG:
+        case OP_GET_RETVAL:
+            return named_var(instr->dest);
+        default:
+            return -1;
+    }
+}
+
+// whether every global may be read at instr: a call may read them,
+// and they outlive a return
+static int instr_reads_globals(Instr *instr) {
+    return (instr->op == OP_CALL && call_touches_globals(instr)) || instr->op == OP_RETURN;
+}
+
+// add the variables instr reads to set
+static void add_uses(Instr *instr, BitWord *set) {
+    if (instr_reads_globals(instr)) {
+        for (int g = 0; g < num_global_vars; g++) BIT_SET(set, global_vars[g]);
+    }
+
+    // the operands of a call are not variables
+    if (instr->op == OP_CALL) return;
+
+    int var = named_var(instr->src1);
+    if (var >= 0) BIT_SET(set, var);
+    var = named_var(instr->src2);
+    if (var >= 0) BIT_SET(set, var);
+}
+
+
+/*************** LIVENESS *****************/
+
+// the variables live before instr, given those live after it
+void live_step(Instr *instr, BitWord *live) {
+    int def = instr_def(instr);
+    if (def >= 0) BIT_CLEAR(live, def);
+    add_uses(instr, live);
+}
+
+// which variables may still be read: a backward may problem over the
+// variables of number_vars, in[b] are those live at the top of b
+// returns 0 if the problem is too large to set up
+int live_vars(Dataflow *df) {
+    if (!df_init(df, DF_BACKWARD, DF_UNION, num_vars)) return 0;
+
+    // gen is what a block reads before it sets it, kill what it sets
+    for (int b = 0; b < cfg.count; b++) {
+        BitWord *gen  = DF_SET(df, gen, b);
+        BitWord *kill = DF_SET(df, kill, b);
+        for (int i = cfg.block[b].end - 1; i >= cfg.block[b].first; i--) {
+            int def = instr_def(&ir.instr[i]);
+            if (def >= 0) {
+                BIT_SET(kill, def);
+                BIT_CLEAR(gen, def);
+            } add_uses(&ir.instr[i], gen);
+        }
+    }
+
+    df_solve(df);
+    return 1;
+}
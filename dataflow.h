@@ -0,0 +1,63 @@
+/*
+ * File: dataflow.h
+ * Author: Maria Fay Garcia
+ * Purpose: To outline the bit vector dataflow solver over the control
+ *          flow graph, and the analyses built on it
+ */
+#ifndef __DATAFLOW_H__
+#define __DATAFLOW_H__
+
+#include "cfg.h"
+
+// dense bit vectors, worked on a word at a time
+typedef unsigned long long BitWord;
+
+#define BIT_WORDS(n)     (((n) + 63) / 64)
+#define BIT_TEST(v, i)   (((v)[(i) / 64] >> ((i) % 64)) & 1)
+#define BIT_SET(v, i)    ((v)[(i) / 64] |=  (1ULL << ((i) % 64)))
+#define BIT_CLEAR(v, i)  ((v)[(i) / 64] &= ~(1ULL << ((i) % 64)))
+
+typedef enum {
+    DF_FORWARD,         // in from the preds' out, out from in
+    DF_BACKWARD         // out from the succs' in, in from out
+} DFDirection;
+
+typedef enum {
+    DF_UNION,           // a fact holds if it does on some path (may)
+    DF_INTERSECT        // a fact holds if it does on every path (must)
+} DFMeet;
+
+/*
+ * A problem in the usual gen/kill form.  For a forward problem
+ *     in[b]  = meet of out[p] over the preds p   (empty at the entry)
+ *     out[b] = gen[b] | (in[b] & ~kill[b])
+ * and a backward one swaps in and out, preds and succs.  Each set is
+ * `words` words long, block b's at b * words.
+ */
+typedef struct {
+    DFDirection  dir;
+    DFMeet       meet;
+    int          num_bits;
+    int          words;
+    BitWord     *gen, *kill;
+    BitWord     *in, *out;
+    int          visits;    // the blocks the last solve went through, for tuning
+} Dataflow;
+
+#define DF_SET(df, sets, b)  (&(df)->sets[(size_t)(b) * (df)->words])
+
+// don't build problems with more than this many words per set array
+#define DF_MAX_WORDS (1 << 22)
+
+// function stubs
+int      df_init          (Dataflow       *df,
+                           DFDirection    dir,
+                           DFMeet        meet,
+                           int       num_bits);
+void     df_solve         (Dataflow       *df);
+int      instr_def        (Instr       *instr);
+void     live_step        (Instr       *instr,
+                           BitWord      *live);
+int      live_vars        (Dataflow       *df);
+
+#endif  /* __DATAFLOW_H__ */
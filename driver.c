@@ -8,6 +8,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include "pass.h"
 
 extern int parse();
 
@@ -22,6 +23,10 @@ int gen_code_flag = 0;      /* set to 1 to generate code */
  *    --chk_decl     : to check legality of declarations
  *    --print_ast    : to print out the AST of each function
  *    --gen_code     : to generate code
+ *    -O0, -O1, -O2, -Os : the optimization level, -O1 by default
+ *    --enable=pass  : to run an optimization pass whatever the level
+ *    --disable=pass : to skip an optimization pass whatever the level
+ *    --pass_stats   : to report what each pass did, on stderr
  */
 void parse_args(int argc, char *argv[]) {
   int i;
@@ -33,6 +38,20 @@ void parse_args(int argc, char *argv[]) {
               print_ast_flag = 1;
           } else if (strcmp(argv[i], "--gen_code") == 0) {
               gen_code_flag = 1;
+          } else if (strcmp(argv[i], "-O0") == 0) {
+              opt_level = OPT_O0;
+          } else if (strcmp(argv[i], "-O1") == 0) {
+              opt_level = OPT_O1;
+          } else if (strcmp(argv[i], "-O2") == 0) {
+              opt_level = OPT_O2;
+          } else if (strcmp(argv[i], "-Os") == 0) {
+              opt_level = OPT_OS;
+          } else if (strncmp(argv[i], "--enable=", 9) == 0) {
+              if (!set_pass(argv[i] + 9, 1)) fprintf(stderr, "Unrecognized pass: %s\n", argv[i] + 9);
+          } else if (strncmp(argv[i], "--disable=", 10) == 0) {
+              if (!set_pass(argv[i] + 10, 0)) fprintf(stderr, "Unrecognized pass: %s\n", argv[i] + 10);
+          } else if (strcmp(argv[i], "--pass_stats") == 0) {
+              pass_stats_flag = 1;
           } else {
               fprintf(stderr, "Unrecognized option: %s\n", argv[i]);
           }
@@ -46,6 +65,7 @@ int main(int argc, char *argv[]) {
   parse_args(argc, argv);
   
   error_code = parse();
+  if (pass_stats_flag) print_pass_stats(stderr);
 
   return error_code;
 }
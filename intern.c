@@ -0,0 +1,88 @@
+/*
+ * File: intern.c
+ * Author: Maria Fay Garcia
+ * Purpose: Identifier interning with an open addressing hash table.
+ *          The strings live in large blocks that are never freed,
+ *          so an interned pointer stays valid for the whole run
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "intern.h"
+
+#define INIT_SLOTS  1024        // must be a power of two
+#define BLOCK_SIZE  65536       // bytes of string storage per block
+
+typedef struct {
+    unsigned int  hash;
+    int           len;
+    char         *str;
+} Atom;
+
+static Atom  *slots     = NULL;
+static int    num_slots = 0;
+static int    num_atoms = 0;
+
+static char  *block     = NULL;   // current string storage block
+static int    block_left = 0;
+
+
+// FNV-1a
+static unsigned int hash_name(char *name, int len) {
+    unsigned int h = 2166136261u;
+    for (int i = 0; i < len; i++) {
+        h ^= (unsigned char)name[i];
+        h *= 16777619u;
+    } return h;
+}
+
+// copy a name into string storage, NUL terminated
+static char *store(char *name, int len) {
+    if (len + 1 > block_left) {
+        int size = len + 1 > BLOCK_SIZE ? len + 1 : BLOCK_SIZE;
+        block = (char *)malloc(size);
+        block_left = size;
+    }
+
+    char *str = block;
+    memcpy(str, name, len);
+    str[len] = '\0';
+    block += len + 1;
+    block_left -= len + 1;
+    return str;
+}
+
+// double the table and re-insert every atom
+static void grow() {
+    int old_num = num_slots;
+    Atom *old = slots;
+
+    num_slots = old_num ? old_num * 2 : INIT_SLOTS;
+    slots = (Atom *)calloc(num_slots, sizeof(Atom));
+
+    for (int i = 0; i < old_num; i++) {
+        if (!old[i].str) continue;
+        int j = old[i].hash & (num_slots - 1);
+        while (slots[j].str) j = (j + 1) & (num_slots - 1);
+        slots[j] = old[i];
+    } free(old);
+}
+
+// return the unique copy of name[0 .. len)
+char *intern(char *name, int len) {
+    // keep the load factor under 1/2
+    if (2 * (num_atoms + 1) > num_slots) grow();
+
+    unsigned int h = hash_name(name, len);
+    int i = h & (num_slots - 1);
+    while (slots[i].str) {
+        if (slots[i].hash == h && slots[i].len == len &&
+            memcmp(slots[i].str, name, len) == 0) return slots[i].str;
+        i = (i + 1) & (num_slots - 1);
+    }
+
+    slots[i].hash = h;
+    slots[i].len  = len;
+    slots[i].str  = store(name, len);
+    num_atoms++;
+    return slots[i].str;
+}
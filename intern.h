@@ -0,0 +1,13 @@
+/*
+ * File: intern.h
+ * Author: Maria Fay Garcia
+ * Purpose: A global pool of interned identifier strings.  Equal names
+ *          intern to the same pointer, so names can be compared with ==
+ */
+#ifndef __INTERN_H__
+#define __INTERN_H__
+
+// function stubs
+char *intern      (char *name, int len);
+
+#endif  /* __INTERN_H__ */
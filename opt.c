@@ -0,0 +1,836 @@
+/*
+ * File: opt.c
+ * Author: Maria Fay Garcia
+ * Purpose: Optimization passes over the three address code of the
+ *          function being compiled, run between lowering and translation
+ */
+#include <limits.h>
+#include "opt.h"
+#include "dataflow.h"
+#include "arena.h"
+
+
+/*************** VARIABLES *****************/
+
+/*
+ * The variables a pass tracks across blocks are the params, locals and
+ * globals the function refers to, numbered densely in the order they
+ * first appear.  Temps are not among them; each one is set once and only
+ * used in the block that sets it, so passes index them by their number.
+ */
+symtab_entry **vars;
+int        num_vars;
+
+// the numbers of the globals among them
+int      *global_vars;
+int   num_global_vars;
+
+// counts the functions, so numbers left on global entries by earlier
+// functions are not mistaken for this one's
+static int func_num = 0;
+
+static void number_var(Operand op) {
+    if (OPND_TYPE(op) != STPTR) return;
+
+    symtab_entry *entry = OPND_ENTRY(op);
+    if (entry->type == FUNC || entry->var_func == func_num) return;
+    entry->var      = num_vars;
+    entry->var_func = func_num;
+    if (entry->scope == GLOBAL) global_vars[num_global_vars++] = num_vars;
+    vars[num_vars++] = entry;
+}
+
+// number the variables of ir
+void number_vars() {
+    func_num++;
+    num_vars = 0;
+    num_global_vars = 0;
+    vars        = (symtab_entry **)arena_alloc(&func_arena, (3 * ir.count + 1) * sizeof(symtab_entry *));
+    global_vars = (int *)arena_alloc(&func_arena, (3 * ir.count + 1) * sizeof(int));
+    for (int i = 0; i < ir.count; i++) {
+        number_var(ir.instr[i].src1);
+        number_var(ir.instr[i].src2);
+        number_var(ir.instr[i].dest);
+    }
+}
+
+// whether the callee of a call may read or assign globals
+// everything but the hand written runtime (println) may
+int call_touches_globals(Instr *call) {
+    return !OPND_ENTRY(call->src1)->is_runtime;
+}
+
+// the number of the variable op names, -1 if it is not a variable
+int named_var(Operand op) {
+    if (OPND_TYPE(op) != STPTR) return -1;
+
+    symtab_entry *entry = OPND_ENTRY(op);
+    if (entry->type == FUNC || entry->var_func != func_num) return -1;
+    return entry->var;
+}
+
+
+/*************** FOLDING *****************/
+
+// evaluate a op b into result, the way the generated code would
+// returns 0 if the code would trap instead (overflow of add, sub or neg,
+// and division by zero), so the instr must be kept
+int fold_arith(OpType op, int a, int b, int *result) {
+    long long r;
+    switch (op) {
+        case OP_PLUS:
+            r = (long long)a + b;
+            break;
+        case OP_MINUS:
+            r = (long long)a - b;
+            break;
+        case OP_UNARY_MINUS:
+            r = -(long long)a;
+            break;
+        case OP_MUL:
+            // mul keeps the low 32 bits
+            *result = (int)((unsigned int)a * (unsigned int)b);
+            return 1;
+        case OP_DIV:
+            if (b == 0 || (a == INT_MIN && b == -1)) return 0;
+            *result = a / b;
+            return 1;
+        default:
+            return 0;
+    }
+
+    if (r < INT_MIN || r > INT_MAX) return 0;
+    *result = (int)r;
+    return 1;
+}
+
+// whether the branch op jumps for a and b
+int eval_comparison(OpType op, int a, int b) {
+    switch (op) {
+        case OP_EQ: return a == b;
+        case OP_NE: return a != b;
+        case OP_LT: return a <  b;
+        case OP_LE: return a <= b;
+        case OP_GT: return a >  b;
+        case OP_GE: return a >= b;
+        default:    return 0;
+    }
+}
+
+
+/*************** CONSTANT PROPAGATION *****************/
+
+LatVal lat_const(int val) { LatVal v = { CONST, val }; return v; }
+LatVal lat_bottom()       { LatVal v = { BOTTOM, 0  }; return v; }
+
+// the values at a join of two paths
+LatVal lat_meet(LatVal a, LatVal b) {
+    if (a.kind == TOP) return b;
+    if (b.kind == TOP) return a;
+    if (a.kind == CONST && b.kind == CONST && a.val == b.val) return a;
+    return lat_bottom();
+}
+
+// the state the propagation works on: one value per named variable
+// and one per temp
+static LatVal *cp_named;
+static LatVal *cp_temps;
+
+// the state at the top of each block, NULL if there would be more than
+// CP_MAX_STATE values: then nothing is known at the top of a block, and
+// the named variables a block sets to something known are all that need
+// forgetting
+#define CP_MAX_STATE (1 << 20)
+static LatVal *cp_in;
+static int    *cp_dirty;
+static int     cp_num_dirty;
+
+static LatVal cp_value(Operand op) {
+    int var;
+    switch (OPND_TYPE(op)) {
+        case ICONST:
+            return lat_const(OPND_INT(op));
+        case TEMP:
+            return cp_temps[OPND_INT(op)];
+        case STPTR:
+            var = named_var(op);
+            if (var >= 0) return cp_named[var];
+            return lat_bottom();
+        default:
+            return lat_bottom();
+    }
+}
+
+static void cp_set_var(int var, LatVal v) {
+    cp_named[var] = v;
+    if (!cp_in && v.kind != BOTTOM) cp_dirty[cp_num_dirty++] = var;
+}
+
+static void cp_set(Operand op, LatVal v) {
+    if (OPND_TYPE(op) == TEMP) {
+        cp_temps[OPND_INT(op)] = v;
+    } else {
+        int var = named_var(op);
+        if (var >= 0) cp_set_var(var, v);
+    }
+}
+
+// load the state at the top of block b
+static void cp_enter_block(int b) {
+    if (cp_in) {
+        memcpy(cp_named, &cp_in[(size_t)b * num_vars], num_vars * sizeof(LatVal));
+    } else {
+        while (cp_num_dirty > 0) cp_named[cp_dirty[--cp_num_dirty]] = lat_bottom();
+    }
+}
+
+// the value of an arithmetic instr, given those of its sources
+static LatVal cp_fold(Instr *instr) {
+    LatVal a = cp_value(instr->src1);
+    LatVal b = instr->op == OP_UNARY_MINUS ? lat_const(0) : cp_value(instr->src2);
+    if (a.kind == BOTTOM || b.kind == BOTTOM) return lat_bottom();
+    if (a.kind == TOP    || b.kind == TOP)    return a.kind == TOP ? a : b;
+
+    int result;
+    if (fold_arith(instr->op, a.val, b.val, &result)) return lat_const(result);
+    return lat_bottom();
+}
+
+// update the state for the effect of instr
+static void cp_transfer(Instr *instr) {
+    switch (instr->op) {
+        case OP_ASSG:
+            cp_set(instr->dest, cp_value(instr->src1));
+            break;
+        case OP_PLUS:
+        case OP_MINUS:
+        case OP_MUL:
+        case OP_DIV:
+        case OP_UNARY_MINUS:
+            cp_set(instr->dest, cp_fold(instr));
+            break;
+        case OP_GET_RETVAL:
+            cp_set(instr->dest, lat_bottom());
+            break;
+        case OP_CALL:
+            // the callee may assign globals
+            if (!call_touches_globals(instr)) break;
+            for (int g = 0; g < num_global_vars; g++) {
+                cp_set_var(global_vars[g], lat_bottom());
+            } break;
+        default:
+            break;
+    }
+}
+
+// replace a source operand by the constant it holds
+static void cp_subst(Operand *op) {
+    LatVal v = cp_value(*op);
+    if (v.kind == CONST && OPND_TYPE(*op) != ICONST) *op = new_operand(ICONST, (void *)&v.val);
+}
+
+// rewrite instr with what is known before it
+// returns 1 if a branch was folded away
+static int cp_rewrite(Instr *instr) {
+    switch (instr->op) {
+        case OP_PLUS:
+        case OP_MINUS:
+        case OP_MUL:
+        case OP_DIV:
+        case OP_UNARY_MINUS:
+        {
+            LatVal v = cp_fold(instr);
+            if (v.kind == CONST) {
+                // the whole instr is a constant
+                instr->op   = OP_ASSG;
+                instr->src1 = new_operand(ICONST, (void *)&v.val);
+                instr->src2 = NO_OPERAND;
+            } else {
+                cp_subst(&instr->src1);
+                if (instr->op != OP_UNARY_MINUS) cp_subst(&instr->src2);
+            } return 0;
+        }
+        case OP_EQ:
+        case OP_NE:
+        case OP_LT:
+        case OP_LE:
+        case OP_GT:
+        case OP_GE:
+        {
+            cp_subst(&instr->src1);
+            cp_subst(&instr->src2);
+            if (OPND_TYPE(instr->src1) != ICONST || OPND_TYPE(instr->src2) != ICONST) return 0;
+
+            // the branch always or never jumps
+            int jumps = eval_comparison(instr->op, OPND_INT(instr->src1), OPND_INT(instr->src2));
+            instr->op   = jumps ? OP_GOTO : OP_NOP;
+            instr->src1 = NO_OPERAND;
+            instr->src2 = NO_OPERAND;
+            return 1;
+        }
+        case OP_ASSG:
+        case OP_PARAM:
+        case OP_SET_RETVAL:
+            cp_subst(&instr->src1);
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+// one round of propagation over the blocks of ir
+// returns 1 if a branch was folded, which may leave more to find
+static int const_prop_round() {
+    int nblocks = cfg.count;
+    if (nblocks == 0) return 0;
+
+    cp_in = NULL;
+    if ((long long)nblocks * num_vars <= CP_MAX_STATE) {
+        cp_in = (LatVal *)arena_alloc(&func_arena, (size_t)nblocks * num_vars * sizeof(LatVal));
+    }
+    cp_dirty     = (int *)arena_alloc(&func_arena, (ir.count + 1) * sizeof(int));
+    cp_num_dirty = 0;
+
+    cp_named = (LatVal *)arena_alloc(&func_arena, (num_vars + 1) * sizeof(LatVal));
+    cp_temps = (LatVal *)arena_alloc(&func_arena, (tmp_num + 1) * sizeof(LatVal));
+    for (int v = 0; v < num_vars; v++) cp_named[v] = lat_bottom();
+
+    // a worklist of the blocks whose in state has changed
+    int  *work    = (int *)arena_alloc(&func_arena, nblocks * sizeof(int));
+    char *queued  = (char *)arena_alloc(&func_arena, nblocks);
+    char *reached = (char *)arena_alloc(&func_arena, nblocks);
+    int   nwork   = 0;
+
+    // nothing is known on entry
+    if (cp_in) memcpy(cp_in, cp_named, num_vars * sizeof(LatVal));
+    work[nwork++] = 0;
+    queued[0] = reached[0] = 1;
+
+    while (nwork > 0) {
+        int b = work[--nwork];
+        queued[b] = 0;
+
+        // run the block from its in state
+        cp_enter_block(b);
+        for (int i = cfg.block[b].first; i < cfg.block[b].end; i++) cp_transfer(&ir.instr[i]);
+
+        // and merge its out state into its successors
+        for (int k = 0; k < 2; k++) {
+            int s = cfg.block[b].succ[k];
+            if (s < 0) continue;
+
+            int changed = !reached[s];
+            reached[s] = 1;
+            if (cp_in) {
+                LatVal *s_in = &cp_in[(size_t)s * num_vars];
+                for (int v = 0; v < num_vars; v++) {
+                    LatVal m = lat_meet(s_in[v], cp_named[v]);
+                    if (m.kind != s_in[v].kind || m.val != s_in[v].val) {
+                        s_in[v] = m;
+                        changed = 1;
+                    }
+                }
+            }
+
+            if (changed && !queued[s]) {
+                queued[s] = 1;
+                work[nwork++] = s;
+            }
+        }
+    }
+
+    // rewrite the blocks that can be reached with what is known
+    int folded = 0;
+    for (int b = 0; b < nblocks; b++) {
+        if (!reached[b]) continue;
+        cp_enter_block(b);
+        for (int i = cfg.block[b].first; i < cfg.block[b].end; i++) {
+            folded |= cp_rewrite(&ir.instr[i]);
+            cp_transfer(&ir.instr[i]);
+        }
+    } return folded;
+}
+
+// constant folding and propagation
+// folding a branch changes the graph, which may give more constants,
+// so go again a few times while that happens
+void const_prop() {
+    for (int round = 0; round < 4; round++) {
+        build_cfg();
+        if (!const_prop_round()) break;
+        ir_compact();
+    }
+}
+
+
+/*************** VALUE NUMBERING *****************/
+
+/*
+ * Within a block, every value gets a number: equal numbers, equal values.
+ * A variable or temp has the number of what was last stored in it, a
+ * constant the number of that constant, and an expression the number
+ * hashed from its op and the numbers of its operands.  Each number keeps
+ * the operand that first held it, so a later use can read that instead.
+ *
+ * Numbers count up across the whole function, so those of an earlier
+ * block never match; the per-variable tables and the hash are stamped
+ * with the block they were filled in for instead of being cleared.
+ */
+#define VN_CONST (-1)   // the op of the key of a constant
+
+typedef struct {
+    int      op;
+    int      a, b;
+    int      vn;
+    int      stamp;     // the block it was made in
+} VNKey;
+
+static VNKey   *vn_table;
+static int      vn_mask;
+static int      vn_count;
+static Operand *vn_holder;      // indexed by number
+
+static int     *vn_of_var, *vn_var_stamp;
+static int     *vn_of_temp, *vn_temp_stamp;
+static int      vn_block;
+
+// a new number, first held in op
+static int vn_new(Operand op) {
+    vn_holder[vn_count] = op;
+    return vn_count++;
+}
+
+// the number of op a b in this block, made (held in holder) if it is new
+// returns it negated and less one if it was new
+static int vn_lookup(int op, int a, int b, Operand holder) {
+    unsigned int h = ((unsigned int)op * 0x9e3779b1u) ^ ((unsigned int)a * 0x85ebca6bu) ^ ((unsigned int)b * 0xc2b2ae35u);
+    int i = (h ^ (h >> 15)) & vn_mask;
+    while (vn_table[i].stamp == vn_block) {
+        VNKey *key = &vn_table[i];
+        if (key->op == op && key->a == a && key->b == b) return key->vn;
+        i = (i + 1) & vn_mask;
+    }
+
+    VNKey *key = &vn_table[i];
+    key->op    = op;
+    key->a     = a;
+    key->b     = b;
+    key->vn    = vn_new(holder);
+    key->stamp = vn_block;
+    return -key->vn - 1;
+}
+
+// the number of the value in op, -1 if it is not a value
+static int vn_value(Operand op) {
+    int var, vn;
+    switch (OPND_TYPE(op)) {
+        case ICONST:
+            vn = vn_lookup(VN_CONST, OPND_INT(op), 0, op);
+            return vn < 0 ? -vn - 1 : vn;
+        case TEMP:
+            var = OPND_INT(op);
+            if (vn_temp_stamp[var] != vn_block) {
+                vn_temp_stamp[var] = vn_block;
+                vn_of_temp[var] = vn_new(op);
+            } return vn_of_temp[var];
+        case STPTR:
+            var = named_var(op);
+            if (var < 0) return -1;
+            if (vn_var_stamp[var] != vn_block) {
+                vn_var_stamp[var] = vn_block;
+                vn_of_var[var] = vn_new(op);
+            } return vn_of_var[var];
+        default:
+            return -1;
+    }
+}
+
+// op now holds the value numbered vn
+static void vn_store(Operand op, int vn) {
+    if (OPND_TYPE(op) == TEMP) {
+        vn_temp_stamp[OPND_INT(op)] = vn_block;
+        vn_of_temp[OPND_INT(op)] = vn;
+    } else {
+        int var = named_var(op);
+        if (var < 0) return;
+        vn_var_stamp[var] = vn_block;
+        vn_of_var[var] = vn;
+    }
+}
+
+// read a source from the operand that first held its value, if that
+// still holds it -- a temp or a constant rather than a stack variable
+static void vn_copy_prop(Operand *op) {
+    int vn = vn_value(*op);
+    if (vn < 0) return;
+
+    Operand holder = vn_holder[vn];
+    if (holder != *op && vn_value(holder) == vn) *op = holder;
+}
+
+// value number the instrs of block b
+static void vn_block_instrs(int b) {
+    vn_block = b;
+    for (int i = cfg.block[b].first; i < cfg.block[b].end; i++) {
+        Instr *instr = &ir.instr[i];
+        switch (instr->op) {
+            case OP_PLUS:
+            case OP_MINUS:
+            case OP_MUL:
+            case OP_DIV:
+            case OP_UNARY_MINUS:
+            {
+                int unary = instr->op == OP_UNARY_MINUS;
+                vn_copy_prop(&instr->src1);
+                if (!unary) vn_copy_prop(&instr->src2);
+
+                // a + b is b + a
+                int a = vn_value(instr->src1);
+                int c = unary ? 0 : vn_value(instr->src2);
+                if ((instr->op == OP_PLUS || instr->op == OP_MUL) && a > c) {
+                    int swap = a;
+                    a = c;
+                    c = swap;
+                }
+
+                int vn = vn_lookup(instr->op, a, c, instr->dest);
+                if (vn >= 0 && vn_value(vn_holder[vn]) == vn) {
+                    // computed before, copy it instead
+                    instr->op   = OP_ASSG;
+                    instr->src1 = vn_holder[vn];
+                    instr->src2 = NO_OPERAND;
+                } else if (vn >= 0) {
+                    // computed before, but no longer held anywhere
+                    vn_holder[vn] = instr->dest;
+                } else {
+                    vn = -vn - 1;
+                } vn_store(instr->dest, vn);
+                break;
+            }
+            case OP_ASSG:
+            {
+                vn_copy_prop(&instr->src1);
+                int vn = vn_value(instr->src1);
+                if (vn_value(instr->dest) == vn) {
+                    // it already holds that value
+                    instr->op = OP_NOP;
+                } else {
+                    vn_store(instr->dest, vn);
+                } break;
+            }
+            case OP_EQ:
+            case OP_NE:
+            case OP_LT:
+            case OP_LE:
+            case OP_GT:
+            case OP_GE:
+                vn_copy_prop(&instr->src1);
+                vn_copy_prop(&instr->src2);
+                break;
+            case OP_PARAM:
+            case OP_SET_RETVAL:
+                vn_copy_prop(&instr->src1);
+                break;
+            case OP_GET_RETVAL:
+                vn_store(instr->dest, vn_new(instr->dest));
+                break;
+            case OP_CALL:
+                // the callee may assign globals
+                if (!call_touches_globals(instr)) break;
+                for (int g = 0; g < num_global_vars; g++) {
+                    vn_var_stamp[global_vars[g]] = -1;
+                } break;
+            default:
+                break;
+        }
+    }
+}
+
+// local value numbering: reuse the values a block has already computed
+void local_value_numbering() {
+    build_cfg();
+
+    int size = 16;
+    while (size < 2 * (ir.count + 1)) size *= 2;
+    vn_table = (VNKey *)arena_alloc(&func_arena, size * sizeof(VNKey));
+    vn_mask  = size - 1;
+    for (int i = 0; i < size; i++) vn_table[i].stamp = -1;
+
+    // at most one new number per operand
+    vn_count  = 0;
+    vn_holder = (Operand *)arena_alloc(&func_arena, (3 * ir.count + 1) * sizeof(Operand));
+
+    vn_of_var     = (int *)arena_alloc(&func_arena, (num_vars + 1) * sizeof(int));
+    vn_var_stamp  = (int *)arena_alloc(&func_arena, (num_vars + 1) * sizeof(int));
+    vn_of_temp    = (int *)arena_alloc(&func_arena, (tmp_num + 1) * sizeof(int));
+    vn_temp_stamp = (int *)arena_alloc(&func_arena, (tmp_num + 1) * sizeof(int));
+    for (int v = 0; v < num_vars; v++) vn_var_stamp[v]  = -1;
+    for (int t = 0; t < tmp_num; t++)  vn_temp_stamp[t] = -1;
+
+    for (int b = 0; b < cfg.count; b++) vn_block_instrs(b);
+    ir_compact();
+}
+
+
+/*************** DEAD CODE *****************/
+
+// drop the blocks control can't reach from the entry
+void remove_unreachable() {
+    build_cfg();
+    if (cfg.count == 0) return;
+
+    char *reached = (char *)arena_alloc(&func_arena, cfg.count);
+    int  *work    = (int *)arena_alloc(&func_arena, cfg.count * sizeof(int));
+    int   nwork   = 0;
+
+    work[nwork++] = 0;
+    reached[0] = 1;
+    while (nwork > 0) {
+        Block *block = &cfg.block[work[--nwork]];
+        for (int k = 0; k < 2; k++) {
+            int s = block->succ[k];
+            if (s >= 0 && !reached[s]) {
+                reached[s] = 1;
+                work[nwork++] = s;
+            }
+        }
+    }
+
+    int removed = 0;
+    for (int b = 0; b < cfg.count; b++) {
+        if (reached[b]) continue;
+        for (int i = cfg.block[b].first; i < cfg.block[b].end; i++) ir.instr[i].op = OP_NOP;
+        removed = 1;
+    } if (removed) ir_compact();
+}
+
+// whether instr only computes its dest, so it can go if dest is not used
+int is_pure_def(OpType op) {
+    switch (op) {
+        case OP_PLUS:
+        case OP_MINUS:
+        case OP_MUL:
+        case OP_DIV:
+        case OP_UNARY_MINUS:
+        case OP_ASSG:
+        case OP_GET_RETVAL:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// remove the stores to variables and temps that are never read
+// temps never live past their block, so only variables need the analysis
+static int dead_store_round() {
+    build_cfg();
+    if (cfg.count == 0) return 0;
+
+    // without the analysis (too large a function), every variable is
+    // taken to be live where control leaves a block
+    Dataflow live;
+    int solved = live_vars(&live);
+    int words  = BIT_WORDS(num_vars);
+    BitWord *cur    = (BitWord *)arena_alloc(&func_arena, (words + 1) * sizeof(BitWord));
+    char *temp_live = (char *)arena_alloc(&func_arena, tmp_num + 1);
+
+    // walk each block backward from what is live at its end
+    int removed = 0;
+    for (int b = 0; b < cfg.count; b++) {
+        if (solved) {
+            memcpy(cur, DF_SET(&live, out, b), words * sizeof(BitWord));
+        } else {
+            memset(cur, 0xff, words * sizeof(BitWord));
+        }
+
+        for (int i = cfg.block[b].end - 1; i >= cfg.block[b].first; i--) {
+            Instr *instr = &ir.instr[i];
+
+            // drop a def no one reads
+            if (is_pure_def(instr->op)) {
+                int var  = named_var(instr->dest);
+                int temp = OPND_TYPE(instr->dest) == TEMP ? OPND_INT(instr->dest) : -1;
+                int used = var >= 0  ? BIT_TEST(cur, var)
+                         : temp >= 0 ? temp_live[temp]
+                         : 1;
+                if (!used) {
+                    instr->op = OP_NOP;
+                    removed = 1;
+                    continue;
+                } if (temp >= 0) temp_live[temp] = 0;
+            }
+
+            live_step(instr, cur);
+            if (instr->op == OP_CALL) continue;
+            if (OPND_TYPE(instr->src1) == TEMP) temp_live[OPND_INT(instr->src1)] = 1;
+            if (OPND_TYPE(instr->src2) == TEMP) temp_live[OPND_INT(instr->src2)] = 1;
+        }
+    }
+
+    if (removed) ir_compact();
+    return removed;
+}
+
+// dead store elimination
+// a dead store may have been the only read of another, so go again
+// a few times while stores are removed
+void dead_store_elim() {
+    for (int round = 0; round < 8 && dead_store_round(); round++);
+}
+
+// give a stack slot only to the locals and temps still in use
+void shrink_frame() {
+    // the locals, in the order they were declared
+    number_vars();
+    frame_locals = 0;
+    for (symtab_entry *cur = symtabs[LOCAL].head; cur; cur = cur->next) {
+        if (cur->type == VAR && !cur->is_param && cur->var_func == func_num) {
+            cur->fp_offset = -4 * ++frame_locals;
+        }
+    }
+
+    // the temps, in the order they are first used
+    int *temp_map = (int *)arena_alloc(&func_arena, (tmp_num + 1) * sizeof(int));
+    int num_temps = 0;
+    for (int t = 0; t < tmp_num; t++) temp_map[t] = -1;
+    for (int i = 0; i < ir.count; i++) {
+        Operand *ops[3] = { &ir.instr[i].src1, &ir.instr[i].src2, &ir.instr[i].dest };
+        for (int k = 0; k < 3; k++) {
+            if (OPND_TYPE(*ops[k]) != TEMP) continue;
+            int t = OPND_INT(*ops[k]);
+            if (temp_map[t] < 0) temp_map[t] = num_temps++;
+            *ops[k] = new_operand(TEMP, (void *)&temp_map[t]);
+        }
+    } tmp_num = num_temps;
+}
+
+
+/*************** JUMPS *****************/
+
+// the index of each label of the function, -1 for one not in it
+static int *lbl_at;
+static int  lbl_lo;
+static int  lbl_count;
+
+static void find_labels() {
+    int lo = INT_MAX, hi = INT_MIN;
+    for (int i = 0; i < ir.count; i++) {
+        if (ir.instr[i].op != OP_LABEL) continue;
+        int label = OPND_INT(ir.instr[i].dest);
+        if (label < lo) lo = label;
+        if (label > hi) hi = label;
+    }
+
+    lbl_lo    = lo;
+    lbl_count = hi >= lo ? hi - lo + 1 : 0;
+    lbl_at    = (int *)arena_alloc(&func_arena, (lbl_count + 1) * sizeof(int));
+    for (int k = 0; k < lbl_count; k++) lbl_at[k] = -1;
+    for (int i = 0; i < ir.count; i++) {
+        if (ir.instr[i].op == OP_LABEL) lbl_at[OPND_INT(ir.instr[i].dest) - lo] = i;
+    }
+}
+
+static int label_index(int label) {
+    int k = label - lbl_lo;
+    return k >= 0 && k < lbl_count ? lbl_at[k] : -1;
+}
+
+// whether control falling into i gets to label with nothing run on the way
+static int falls_to(int i, int label) {
+    for (; i < ir.count && (ir.instr[i].op == OP_LABEL || ir.instr[i].op == OP_NOP); i++) {
+        if (ir.instr[i].op == OP_LABEL && OPND_INT(ir.instr[i].dest) == label) return 1;
+    } return 0;
+}
+
+// the branch that jumps whenever op does not
+static OpType negate_branch(OpType op) {
+    switch (op) {
+        case OP_EQ: return OP_NE;
+        case OP_NE: return OP_EQ;
+        case OP_LT: return OP_GE;
+        case OP_LE: return OP_GT;
+        case OP_GT: return OP_LE;
+        default:    return OP_LT;
+    }
+}
+
+// where a jump to label ends up, going through the gotos it lands on
+// the hops are bounded, so a loop of gotos ends too
+static int final_target(int label) {
+    for (int hops = 0; hops < ir.count; hops++) {
+        int i = label_index(label);
+        if (i < 0) break;
+        while (i < ir.count && (ir.instr[i].op == OP_LABEL || ir.instr[i].op == OP_NOP)) i++;
+        if (i == ir.count || ir.instr[i].op != OP_GOTO) break;
+
+        int next = OPND_INT(ir.instr[i].dest);
+        if (next == label) break;
+        label = next;
+    } return label;
+}
+
+// one round over the jumps of ir
+// returns 1 if anything changed, which may leave more to do
+static int thread_round() {
+    find_labels();
+    int changed = 0;
+
+    for (int i = 0; i < ir.count; i++) {
+        Instr *instr = &ir.instr[i];
+        if (instr->op != OP_GOTO && !is_cond_branch(instr->op)) continue;
+
+        // a jump to a goto goes where the goto goes
+        int target = final_target(OPND_INT(instr->dest));
+        if (target != OPND_INT(instr->dest)) {
+            instr->dest = new_operand(LABEL, (void *)&target);
+            changed = 1;
+        }
+
+        // a branch over a goto branches the other way, to where it goes
+        Instr *next = &ir.instr[i + 1];
+        if (is_cond_branch(instr->op) && i + 1 < ir.count && next->op == OP_GOTO && falls_to(i + 2, target)) {
+            instr->op   = negate_branch(instr->op);
+            instr->dest = next->dest;
+            next->op    = OP_NOP;
+            changed = 1;
+        }
+
+        // a jump to where control goes anyway
+        if (falls_to(i + 1, OPND_INT(instr->dest))) {
+            instr->op = OP_NOP;
+            changed = 1;
+        }
+    }
+
+    // the code after a goto or return, up to the next label, is never run
+    for (int i = 0; i < ir.count; i++) {
+        if (ir.instr[i].op != OP_GOTO && ir.instr[i].op != OP_RETURN) continue;
+        for (int j = i + 1; j < ir.count && ir.instr[j].op != OP_LABEL; j++) {
+            if (ir.instr[j].op != OP_NOP) changed = 1;
+            ir.instr[j].op = OP_NOP;
+        }
+    }
+
+    // the labels nothing jumps to
+    char *used = (char *)arena_alloc(&func_arena, lbl_count + 1);
+    for (int i = 0; i < ir.count; i++) {
+        Instr *instr = &ir.instr[i];
+        if (instr->op == OP_GOTO || is_cond_branch(instr->op)) used[OPND_INT(instr->dest) - lbl_lo] = 1;
+    }
+    for (int i = 0; i < ir.count; i++) {
+        if (ir.instr[i].op == OP_LABEL && !used[OPND_INT(ir.instr[i].dest) - lbl_lo]) {
+            ir.instr[i].op = OP_NOP;
+            changed = 1;
+        }
+    }
+
+    ir_compact();
+    return changed;
+}
+
+// jump threading: jumps to gotos go straight to where those go, a branch
+// over a goto is turned around, and jumps to the next instr, the code
+// after a jump and the labels nothing jumps to are dropped
+void thread_jumps() {
+    for (int round = 0; round < 8 && thread_round(); round++);
+}
@@ -0,0 +1,59 @@
+/*
+ * File: opt.h
+ * Author: Maria Fay Garcia
+ * Purpose: To outline the optimization passes run over the
+ *          three address code of a function before it is translated
+ */
+#ifndef __OPT_H__
+#define __OPT_H__
+
+#include "code_gen.h"
+#include "cfg.h"
+
+// the variables the function being optimized refers to, see number_vars
+extern symtab_entry **vars;
+extern int        num_vars;
+extern int     *global_vars;
+extern int  num_global_vars;
+
+/*
+ * What is known about a variable at a point of the code: nothing yet
+ * (TOP, the point has not been reached), that it always holds val, or
+ * that it may hold more than one value (BOTTOM).  TOP is 0 so a zeroed
+ * array starts out knowing nothing.
+ */
+typedef enum {
+    TOP,
+    CONST,
+    BOTTOM
+} LatKind;
+
+typedef struct {
+    LatKind  kind;
+    int      val;
+} LatVal;
+
+// function stubs
+void     const_prop               (                    );
+void     local_value_numbering    (                    );
+void     remove_unreachable       (                    );
+void     thread_jumps             (                    );
+void     dead_store_elim          (                    );
+void     shrink_frame             (                    );
+void     number_vars              (                    );
+int      named_var                (Operand           op);
+int      call_touches_globals     (Instr         *call);
+int      is_pure_def              (OpType            op);
+int      fold_arith               (OpType            op,
+                                   int                a,
+                                   int                b,
+                                   int          *result);
+int      eval_comparison          (OpType            op,
+                                   int                a,
+                                   int                b);
+LatVal   lat_const                (int              val);
+LatVal   lat_bottom               (                    );
+LatVal   lat_meet                 (LatVal             a,
+                                   LatVal             b);
+
+#endif  /* __OPT_H__ */
@@ -11,22 +11,28 @@
 
 // globals
 Token cur_tok;
+int   tok_idx;          // index of cur_tok in toks
 Scope cur_scope;
 
 // function implementations
 
 int parse() {
-    // set up transition table for scanner
-    setup_table();
+    // read the program into memory and tokenize all of it
+    load_source(0);
+    scan_all();
 
     // get the first token
-    cur_tok = get_token();
+    tok_idx = 0;
+    cur_tok = toks.kind[0];
 
     // put println in the symbol table so program doesn't die
     // (must do only when semantic checking is enable to avoid seg fault)
     if (chk_decl_flag) {
-        symtab_entry *println = add_decl("println", FUNC);
+        symtab_entry *println = add_decl(intern("println", 7), FUNC);
         println->num_args = 1;
+        println->is_runtime     = 1;
+        println->clobbers       = PRINTLN_CLOBBERS;
+        println->clobbers_known = 1;
     }
 
     // start at the start symbol of the grammar
@@ -48,24 +54,23 @@ void do_code_gen_things() {
 }
 
 void prog() {
-    cur_scope = GLOBAL;
-    if (cur_tok == kwINT) {
+    while (cur_tok == kwINT) {
+        cur_scope = GLOBAL;
         type();
-        char *lexeme_to_pass = lexeme;
+        char *name = toks.atom[tok_idx];
         match(ID);
-        decl_or_func(lexeme_to_pass);
-        prog();
+        decl_or_func(name);
     }
 }
 
-void decl_or_func(char *passed_lexeme) {
+void decl_or_func(char *name) {
     if (cur_tok == COMMA) {
         // VAR DECL
         
         // SEMANTIC CHECKING
 
         // add declaration to symbol table
-        add_decl(passed_lexeme, VAR);
+        add_decl(name, VAR);
 
         match(COMMA);
         id_list();
@@ -73,28 +78,29 @@ void decl_or_func(char *passed_lexeme) {
     } else if (cur_tok == LPAREN) {
         // FUNCTION DECLARATION
 
-        // initialize and zero out ast node
-        ASTNode *func = (ASTNode *) calloc(1, sizeof(ASTNode));
-        func->type = FUNC_DEF;
+        // the function is the first node in the pool
+        NodeId func = ast_new_node(FUNC_DEF, tok_idx);
         
         // SEMANTIC CHECKING
 
         // add declaration to symbol table
-        symtab_entry *new_entry = add_decl(passed_lexeme, FUNC);
+        symtab_entry *new_entry = add_decl(name, FUNC);
 
         // FILL AST NODE
-        func->symtab_entry = new_entry;
+        AST(func)->sym = ast_new_sym(name, new_entry);
 
         match(LPAREN);
         cur_scope = LOCAL;
 
-        func->child0 = opt_formals();
+        NodeId formals = opt_formals();
+        AST(func)->child0 = formals;
         match(RPAREN);
         match(LBRACE);
         opt_var_decls();
         
         // add the body of the function to the AST
-        func->child1 = opt_stmt_list();
+        NodeId body = opt_stmt_list();
+        AST(func)->child1 = body;
 
         match(RBRACE);
 
@@ -102,22 +108,23 @@ void decl_or_func(char *passed_lexeme) {
         if (chk_decl_flag) perform_semantic_checking(func);
 
         // print the AST if requested
-        if (print_ast_flag) print_ast(func);
-
-        // TODO: FREE AST HERE
+        if (print_ast_flag) print_ast(AST(func));
 
         // generate the code if requested
         if (gen_code_flag) gen_mips_code(func);
 
         // pop the scope and clear local symbol table
-        // TODO: free this memory -- clear local symbol table somewhere else?
         cur_scope = GLOBAL;
-        symtab_hds[LOCAL] = NULL;
+        clear_scope(LOCAL);
+
+        // the AST, the code and the local symbols all go at once
+        ast_reset();
+        arena_reset(&func_arena);
 
     } else {
 
         // add the declaration to the symbol table
-        add_decl(passed_lexeme, VAR);
+        add_decl(name, VAR);
 
         match(SEMI);
     }
@@ -132,21 +139,20 @@ void var_decl() {
 void id_list() {
 
     // add declaration to symbol table
-    add_decl(lexeme, VAR);
+    add_decl(toks.atom[tok_idx], VAR);
 
     match(ID);
     id_list_rest();
 }
 
 void id_list_rest() {
-    if (cur_tok == COMMA) {
+    while (cur_tok == COMMA) {
         match(COMMA);
 
         // add declaration to symbol table
-        add_decl(lexeme, VAR);
+        add_decl(toks.atom[tok_idx], VAR);
 
         match(ID);
-        id_list_rest();
     }
 }
 
@@ -154,86 +160,84 @@ void type() {
     match(kwINT);
 }
 
-ASTNode* opt_formals() {
+NodeId opt_formals() {
     if (cur_tok == kwINT) {
         return formals();
-    } return NULL;
+    } return 0;
 }
 
-ASTNode* formals() {
+NodeId formals() {
 
-    // initialize and zero out ast node
-    ASTNode* ast_node = (ASTNode *) calloc(1, sizeof(ASTNode));
-    ast_node->type = EXPR_LIST;
+    NodeId ast_node = ast_new_node(EXPR_LIST, tok_idx);
 
     type();
 
     // add delcaration to symbol table
+    symtab_entry *entry = NULL;
     if (chk_decl_flag) {
-        symtab_entry *entry = add_decl(lexeme, VAR);
-        entry->is_param = 1;
-        ast_node->symtab_entry = entry;
+        entry = add_decl(toks.atom[tok_idx], VAR);
+        mark_param(entry);
     }
+    AST(ast_node)->sym = ast_new_sym(toks.atom[tok_idx], entry);
 
     match(ID);
-    ast_node->child0 = formals_rest();
+    NodeId rest = formals_rest();
+    AST(ast_node)->child0 = rest;
 
     return ast_node;
 }
 
-ASTNode* formals_rest() {
+NodeId formals_rest() {
+    // built front to back, the formals are chained through child0
+    NodeId head = 0, tail = 0;
 
-    if (cur_tok == COMMA) {
-        ASTNode* ast_node = (ASTNode *) calloc(1, sizeof(ASTNode));
-        ast_node->type = EXPR_LIST;
+    while (cur_tok == COMMA) {
+        NodeId ast_node = ast_new_node(EXPR_LIST, tok_idx);
+        if (tail) AST(tail)->child0 = ast_node;
+        else head = ast_node;
+        tail = ast_node;
 
         match(COMMA);
         type();
 
         // add declaration to symbol table
+        symtab_entry *entry = NULL;
         if (chk_decl_flag) {
-            symtab_entry *entry = add_decl(lexeme, VAR);
-            entry->is_param = 1;
-            ast_node->symtab_entry = entry;
+            entry = add_decl(toks.atom[tok_idx], VAR);
+            mark_param(entry);
         }
+        AST(ast_node)->sym = ast_new_sym(toks.atom[tok_idx], entry);
 
         match(ID);
-
-        // add the rest of the declarations
-        ast_node->child0 = formals_rest();
-
-        return ast_node;
-    } return NULL;
-
+    } return head;
 }
 
 void opt_var_decls() { 
-    if (cur_tok == kwINT) {
-        var_decl();
-        opt_var_decls();
-    }
+    while (cur_tok == kwINT) var_decl();
 }
 
-ASTNode* opt_stmt_list() {
-    // check follow set for this non-terminal
-    if (cur_tok == RBRACE) return NULL;
+NodeId opt_stmt_list() {
+    // built front to back, the list nodes are chained through child1
+    NodeId head = 0, tail = 0;
 
-    // initialize and zero out ast node
-    ASTNode* ast_node = (ASTNode *) calloc(1, sizeof(ASTNode));
-    ast_node->type = STMT_LIST;
+    // check follow set for this non-terminal
+    while (cur_tok != RBRACE) {
+        NodeId ast_node = ast_new_node(STMT_LIST, tok_idx);
+        if (tail) AST(tail)->child1 = ast_node;
+        else head = ast_node;
+        tail = ast_node;
 
-    ast_node->child0 = stmt();
-    ast_node->child1 = opt_stmt_list();
-    
-    return ast_node;
+        NodeId cur_stmt = stmt();
+        AST(ast_node)->child0 = cur_stmt;
+    } return head;
 }
 
-ASTNode* stmt() {
-    ASTNode* stmt = NULL;
+NodeId stmt() {
+    NodeId stmt = 0;
     if (cur_tok == ID) {
-        char *lexeme_to_pass = lexeme;
+        char *name = toks.atom[tok_idx];
         match(ID);
-        stmt = fn_call_or_assg_stmt(lexeme_to_pass, line_num, col_num);
+        stmt = fn_call_or_assg_stmt(name, tok_idx);
         match(SEMI);
     } else if (cur_tok == kwWHILE) {
         stmt = while_stmt();
@@ -252,185 +256,171 @@ ASTNode* stmt() {
     return stmt;
 }
 
-ASTNode* fn_call_or_assg_stmt(char *passed_lexeme, int line_num, int col_num) {
-    // initialize and zero out ast node
-    ASTNode* ast_node = (ASTNode *) calloc(1, sizeof(ASTNode));
-
+NodeId fn_call_or_assg_stmt(char *name, int tok) {
     // for semantic checking
-    ast_node->line_num = line_num;
-    ast_node->col_num  = col_num;
-    ast_node->lexeme   = passed_lexeme;
-    symtab_entry *entry = symtab_lookup(passed_lexeme);
+    NodeId ast_node = ast_new_node(cur_tok == LPAREN ? FUNC_CALL : ASSG, tok);
+
+    // this is the callee, or the LHS of the assg stmt
+    AST(ast_node)->sym = ast_new_sym(name, symtab_lookup(name));
 
     if (cur_tok == LPAREN) {
         // FUNCTION CALL
-        
-        // set type of ast node
-        ast_node->type = FUNC_CALL;
-
-        // add symtab_entry to AST
-        ast_node->symtab_entry = entry;
-
         match(LPAREN);
 
         // fill the ast with the arguments passed to the function
-        ast_node->child0 = opt_expr_list();
+        NodeId args = opt_expr_list();
+        AST(ast_node)->child0 = args;
 
         match(RPAREN);
     } else {
         // VARIABLE ASSIGNMENT
-
-        // set type of ast node
-        ast_node->type = ASSG;
-
-        // TODO: symtab_entry shouldn't be stored in ASTNode for ASSG...,
-        // but it's technically correct here since we only have IDs
-        
-        // set symtab entry field of ast node
-        // this is the LHS of the assg stmt
-        ast_node->symtab_entry = entry;
-
         match(opASSG);
 
         // fill the RHS of the assg stmt
-        ast_node->child0 = arith_exp();
+        NodeId rhs = arith_exp();
+        AST(ast_node)->child0 = rhs;
     }
 
     return ast_node;
 }
 
 
-ASTNode* if_stmt() {
-    // initialize and zero out ast node
-    ASTNode* ast_node = (ASTNode *) calloc(1, sizeof(ASTNode));
-    ast_node->type = IF;
+NodeId if_stmt() {
+    NodeId ast_node = ast_new_node(IF, tok_idx);
 
     match(kwIF);
     match(LPAREN);
-    ast_node->child0 = bool_exp();
+    NodeId cond = bool_exp();
     match(RPAREN);
-    ast_node->child1 = stmt();
-    ast_node->child2 = else_stmt();
+    NodeId then_part = stmt();
+    NodeId else_part = else_stmt();
 
+    AST(ast_node)->child0 = cond;
+    AST(ast_node)->child1 = then_part;
+    AST(ast_node)->child2 = else_part;
     return ast_node;
 }
 
 
-ASTNode* else_stmt() {
-    // initialize and zero out ast node
+NodeId else_stmt() {
     if (cur_tok == kwELSE) {
         match(kwELSE);
         return stmt();
-    } return NULL;
+    } return 0;
 }
 
-ASTNode* while_stmt() {
-    // initialize and zero out ast node
-    ASTNode* ast_node = (ASTNode *) calloc(1, sizeof(ASTNode));
-    ast_node->type = WHILE;
+NodeId while_stmt() {
+    NodeId ast_node = ast_new_node(WHILE, tok_idx);
 
     match(kwWHILE);
     match(LPAREN);
-    ast_node->child0 = bool_exp();
+    NodeId cond = bool_exp();
     match(RPAREN);
-    ast_node->child1 = stmt();
+    NodeId body = stmt();
 
+    AST(ast_node)->child0 = cond;
+    AST(ast_node)->child1 = body;
     return ast_node;
 }
 
-ASTNode* return_stmt() {
-    // initialize and zero out ast node
-    ASTNode* ast_node = (ASTNode *) calloc(1, sizeof(ASTNode));
-    ast_node->type = RETURN;
+NodeId return_stmt() {
+    NodeId ast_node = ast_new_node(RETURN, tok_idx);
 
     match(kwRETURN);
-    ast_node->child0 = return_bdy();
+    NodeId expr = return_bdy();
+    AST(ast_node)->child0 = expr;
     match(SEMI);
 
     return ast_node;
 }
 
-ASTNode* return_bdy() {
-    if (cur_tok == SEMI) return NULL;
+NodeId return_bdy() {
+    if (cur_tok == SEMI) return 0;
     return arith_exp();
 }
 
-ASTNode* opt_expr_list() {
-    if (cur_tok == RPAREN) return NULL;
+NodeId opt_expr_list() {
+    if (cur_tok == RPAREN) return 0;
     return expr_list();
 }
 
-ASTNode* expr_list() {
-    // initialize and zero out ast node
-    ASTNode* ast_node = (ASTNode *) calloc(1, sizeof(ASTNode));
-    ast_node->type = EXPR_LIST;
+NodeId expr_list() {
+    NodeId ast_node = ast_new_node(EXPR_LIST, tok_idx);
     
-    ast_node->child0 = arith_exp();
-    ast_node->child1 = rest_expr_list();
+    NodeId head = arith_exp();
+    AST(ast_node)->child0 = head;
+    NodeId rest = rest_expr_list();
+    AST(ast_node)->child1 = rest;
     
     return ast_node;
 }
 
-ASTNode* rest_expr_list() {
-    if (cur_tok == COMMA) {
-        // initialize and zero out ast node
-        ASTNode* ast_node = (ASTNode *) calloc(1, sizeof(ASTNode));
-        ast_node->type = EXPR_LIST;
+NodeId rest_expr_list() {
+    // built front to back, the list nodes are chained through child1
+    NodeId head = 0, tail = 0;
 
-        match(COMMA);
-        ast_node->child0 = arith_exp();
-        ast_node->child1 = rest_expr_list();
+    while (cur_tok == COMMA) {
+        NodeId ast_node = ast_new_node(EXPR_LIST, tok_idx);
+        if (tail) AST(tail)->child1 = ast_node;
+        else head = ast_node;
+        tail = ast_node;
 
-        return ast_node;
-    } return NULL;
+        match(COMMA);
+        NodeId expr = arith_exp();
+        AST(ast_node)->child0 = expr;
+    } return head;
 }
 
-ASTNode* bool_exp() {
-    ASTNode *left = bool_exp_2();
+NodeId bool_exp() {
+    NodeId left = bool_exp_2();
 
     while (cur_tok == opOR) {
 
         match(opOR);
 
-        ASTNode *new_node = (ASTNode *)calloc(1, sizeof(ASTNode));
-        new_node->type = OR;
-        new_node->child0 = left;
-        new_node->child1 = bool_exp_2();
+        NodeId new_node = ast_new_node(OR, tok_idx);
+        NodeId right = bool_exp_2();
+        AST(new_node)->child0 = left;
+        AST(new_node)->child1 = right;
 
         left = new_node;
     } return left;
 }
 
-ASTNode* bool_exp_2() {
-    ASTNode *left = bool_exp_arith();
+NodeId bool_exp_2() {
+    NodeId left = bool_exp_arith();
 
     while (cur_tok == opAND) {
 
         match(opAND);
 
-        ASTNode *new_node = (ASTNode *)calloc(1, sizeof(ASTNode));
-        new_node->type = AND;
-        new_node->child0 = left;
-        new_node->child1 = bool_exp_arith();
+        NodeId new_node = ast_new_node(AND, tok_idx);
+        NodeId right = bool_exp_arith();
+        AST(new_node)->child0 = left;
+        AST(new_node)->child1 = right;
 
         left = new_node;
     } return left;
 
 }
 
-ASTNode* bool_exp_arith() {
-    // initialize and zero out ast node
-    ASTNode* ast_node = (ASTNode *) calloc(1, sizeof(ASTNode));
+NodeId bool_exp_arith() {
+    // the type is filled in once the relop is known
+    NodeId ast_node = ast_new_node(DUMMY, tok_idx);
 
-    ast_node->child0 = arith_exp();
-    ast_node->type = relop();
-    ast_node->child1 = arith_exp();
+    NodeId left = arith_exp();
+    int type = relop();
+    NodeId right = arith_exp();
+
+    AST(ast_node)->type   = type;
+    AST(ast_node)->child0 = left;
+    AST(ast_node)->child1 = right;
     return ast_node;
 }
 
-ASTNode *arith_exp() {
+NodeId arith_exp() {
 
-    ASTNode *left = arith_exp_2();
+    NodeId left = arith_exp_2();
 
     while (cur_tok == opADD || cur_tok == opSUB) {
         // retrieve what type the AST node should be
@@ -438,10 +428,10 @@ ASTNode *arith_exp() {
 
         match(cur_tok);
 
-        ASTNode *new_node = (ASTNode *)calloc(1, sizeof(ASTNode));
-        new_node->type = type;
-        new_node->child0 = left;
-        new_node->child1 = arith_exp_2();
+        NodeId new_node = ast_new_node(type, tok_idx);
+        NodeId right = arith_exp_2();
+        AST(new_node)->child0 = left;
+        AST(new_node)->child1 = right;
 
         left = new_node;
 
@@ -449,9 +439,9 @@ ASTNode *arith_exp() {
 
 }
 
-ASTNode* arith_exp_2() {
+NodeId arith_exp_2() {
 
-    ASTNode *left = arith_exp_3();
+    NodeId left = arith_exp_3();
 
     while (cur_tok == opMUL || cur_tok == opDIV) {
         // retrieve what type the AST node should be
@@ -459,10 +449,10 @@ ASTNode* arith_exp_2() {
 
         match(cur_tok);
 
-        ASTNode *new_node = (ASTNode *)calloc(1, sizeof(ASTNode));
-        new_node->type = type;
-        new_node->child0 = left;
-        new_node->child1 = arith_exp_3();
+        NodeId new_node = ast_new_node(type, tok_idx);
+        NodeId right = arith_exp_3();
+        AST(new_node)->child0 = left;
+        AST(new_node)->child1 = right;
 
         left = new_node;
 
@@ -470,15 +460,14 @@ ASTNode* arith_exp_2() {
 
 }
 
-ASTNode* arith_exp_3() {
+NodeId arith_exp_3() {
 
     if (cur_tok == opSUB) {
         match(opSUB);
 
-        ASTNode *ast_node = (ASTNode *)calloc(1, sizeof(ASTNode));
-
-        ast_node->type = UMINUS;
-        ast_node->child0 = arith_exp_3();
+        NodeId ast_node = ast_new_node(UMINUS, tok_idx);
+        NodeId operand = arith_exp_3();
+        AST(ast_node)->child0 = operand;
 
         return ast_node;
 
@@ -488,9 +477,9 @@ ASTNode* arith_exp_3() {
 
 }
 
-ASTNode* arith_exp_4() {
+NodeId arith_exp_4() {
 
-    ASTNode *to_return;
+    NodeId to_return;
     if (cur_tok == LPAREN) {
         match(LPAREN);
         to_return = arith_exp();
@@ -501,41 +490,36 @@ ASTNode* arith_exp_4() {
 
 }
 
-ASTNode* val() {
-
-    // initialize and zero out ast node
-    ASTNode* ast_node = (ASTNode *) calloc(1, sizeof(ASTNode));
+NodeId val() {
 
     // for semantic checking
-    ast_node->line_num = line_num;
-    ast_node->col_num  = col_num;
-    ast_node->lexeme   = lexeme;
+    NodeId ast_node = ast_new_node(INTCONST, tok_idx);
 
     if (cur_tok == ID) {
 
         // ID OR FUNC_CALL
-
-        ast_node->symtab_entry = symtab_lookup(lexeme);
+        char *name = toks.atom[tok_idx];
+        AST(ast_node)->sym = ast_new_sym(name, symtab_lookup(name));
         match(ID);
 
         if (cur_tok == LPAREN) {
             // FUNC CALL
-            ast_node->type = FUNC_CALL;
+            AST(ast_node)->type = FUNC_CALL;
 
             match(LPAREN);
-            ast_node->child0 = opt_expr_list();
+            NodeId args = opt_expr_list();
+            AST(ast_node)->child0 = args;
             match(RPAREN);
         } else {
             // ID
-            ast_node->type = IDENTIFIER;
+            AST(ast_node)->type = IDENTIFIER;
         }
     } else {
 
         // INTCON
-        ast_node->type = INTCONST;
 
         // put integer constant in AST node
-        ast_node->intcon = intcon;
+        AST(ast_node)->intcon = toks.value[tok_idx];
         match(INTCON);
 
     } return ast_node;
@@ -569,10 +553,15 @@ int relop() {
 // check whether the current token matches the expected one
 void match(Token expected) {
     if (cur_tok == expected) {
-        cur_tok = get_token();
+        // EOF is the last token, stay on it
+        if (cur_tok != EOF) tok_idx++;
+        cur_tok = toks.kind[tok_idx];
     } else {
         // syntax error
-        fprintf(stderr, "SYNTAX ERROR IN LINE %d: unexpected token %d [lexeme = %s]\n", line_num, cur_tok, lexeme);
+        int line, col;
+        tok_position(tok_idx, &line, &col);
+        fprintf(stderr, "SYNTAX ERROR IN LINE %d: unexpected token %d [lexeme = %.*s]\n",
+                line, cur_tok, toks.len[tok_idx], src_buf + toks.start[tok_idx]);
         exit(1);
     }
 }
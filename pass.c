@@ -0,0 +1,125 @@
+/*
+ * File: pass.c
+ * Author: Maria Fay Garcia
+ * Purpose: The pass manager: the table of optimization passes, which of
+ *          them run at each level or by request, and what each one did
+ */
+#include <string.h>
+#include <time.h>
+#include "pass.h"
+#include "opt.h"
+#include "ssa.h"
+#include "regalloc.h"
+#include "peep.h"
+#include "asm.h"
+
+OptLevel opt_level     = OPT_O1;
+int     pass_stats_flag = 0;
+
+typedef struct {
+    char      *name;        // as given to --enable= and --disable=
+    void     (*run)();
+    OptLevel   level;       // the lowest level it runs at
+    int        grows;       // whether it may make the code larger, so -Os leaves it out
+    int        on_asm;      // whether it runs over the mips code, once it is translated
+    int        forced;      // -1 if the level decides, else 0 or 1 from the command line
+
+    // what it has done over the run
+    int        runs;
+    long long  removed;     // instrs
+    long long  added;
+    double     secs;
+} Pass;
+
+// the passes, in the order they run
+static Pass passes[] = {
+    { "const_prop",   const_prop,            OPT_O1, 0, 0, -1 },
+    { "unreachable",  remove_unreachable,    OPT_O1, 0, 0, -1 },
+    { "jumps",        thread_jumps,          OPT_O1, 0, 0, -1 },
+    { "ssa",          ssa_optimize,          OPT_O2, 0, 0, -1 },
+    { "lvn",          local_value_numbering, OPT_O1, 0, 0, -1 },
+    { "dse",          dead_store_elim,       OPT_O1, 0, 0, -1 },
+    { "shrink_frame", shrink_frame,          OPT_O1, 0, 0, -1 },
+    { "regalloc",     alloc_registers,       OPT_O1, 0, 0, -1 },
+    { "regstack",     stack_registers,       OPT_O0, 0, 0, -1 },
+    { "share_slots",  share_stack_slots,     OPT_O1, 0, 0, -1 },
+    { "peephole",     peephole,              OPT_O1, 0, 1, -1 },
+};
+
+#define NUM_PASSES ((int)(sizeof(passes) / sizeof(passes[0])))
+
+static int pass_enabled(Pass *pass) {
+    if (pass->forced >= 0) return pass->forced;
+    switch (opt_level) {
+        case OPT_O0: return pass->level == OPT_O0;
+        case OPT_O1: return pass->level <= OPT_O1;
+        case OPT_O2: return pass->level <= OPT_O2;
+        case OPT_OS: return pass->level <= OPT_O2 && !pass->grows;
+    } return 0;
+}
+
+// turn the pass called name on or off whatever the level
+// returns 0 if there is no such pass
+int set_pass(char *name, int enable) {
+    for (int p = 0; p < NUM_PASSES; p++) {
+        if (strcmp(passes[p].name, name) == 0) {
+            passes[p].forced = enable;
+            return 1;
+        }
+    } return 0;
+}
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// the size of the code a pass runs over
+static int code_size(Pass *pass) {
+    return pass->on_asm ? asm_instr_count() : ir.count;
+}
+
+static void run_stage(int on_asm) {
+    for (int p = 0; p < NUM_PASSES; p++) {
+        Pass *pass = &passes[p];
+        if (pass->on_asm != on_asm || !pass_enabled(pass)) continue;
+
+        int    before = code_size(pass);
+        double start  = pass_stats_flag ? now() : 0;
+        pass->run();
+        if (pass_stats_flag) pass->secs += now() - start;
+
+        pass->runs++;
+        int after = code_size(pass);
+        if (after < before) {
+            pass->removed += before - after;
+        } else {
+            pass->added += after - before;
+        }
+    }
+}
+
+// run the enabled passes over ir
+void run_passes() {
+    // the passes find the variables by their numbers
+    number_vars();
+    run_stage(0);
+}
+
+// run the enabled passes over the mips code of the function
+void run_asm_passes() {
+    run_stage(1);
+}
+
+// a table of what each pass did, over every function it ran on
+void print_pass_stats(FILE *out) {
+    fprintf(out, "%-14s %6s %10s %10s %10s\n", "pass", "runs", "removed", "added", "ms");
+    for (int p = 0; p < NUM_PASSES; p++) {
+        Pass *pass = &passes[p];
+        fprintf(out, "%-14s %6d %10lld %10lld %10.3f\n",
+                pass->name, pass->runs, pass->removed, pass->added, pass->secs * 1e3);
+    }
+    fprintf(out, "\n");
+    print_peep_stats(out);
+}
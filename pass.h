@@ -0,0 +1,34 @@
+/*
+ * File: pass.h
+ * Author: Maria Fay Garcia
+ * Purpose: To outline the pass manager, which runs the optimization
+ *          passes over each function between lowering and translation,
+ *          and over its mips code before it is printed
+ */
+#ifndef __PASS_H__
+#define __PASS_H__
+
+#include <stdio.h>
+
+typedef enum {
+    OPT_O0,             // no optimization, only the register stack
+    OPT_O1,             // the cheap local and dataflow passes (the default)
+    OPT_O2,             // those and the SSA tier
+    OPT_OS              // what -O2 runs, but for passes that grow the code,
+                        // with registers given out for size (see regalloc.c)
+} OptLevel;
+
+// set by -O0, -O1, -O2 and -Os
+extern OptLevel opt_level;
+
+// set to 1 to report what each pass did at the end of the run
+extern int pass_stats_flag;
+
+// function stubs
+void     run_passes       (                      );
+void     run_asm_passes   (                      );
+int      set_pass         (char          *name,
+                           int          enable);
+void     print_pass_stats (FILE           *out);
+
+#endif  /* __PASS_H__ */
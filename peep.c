@@ -0,0 +1,81 @@
+/*
+ * File: peep.c
+ * Author: Maria Fay Garcia
+ * Purpose: The peephole pass.  It tries the rules of peep.rules, compiled
+ *          into peep_table.h by peep_gen, at each line of the mips code
+ *          of the function, until none of them matches anywhere
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "peep.h"
+#include "arena.h"
+
+// whether line is the instr op with num_args operands
+static int peep_instr(AsmLine *line, char *op, int num_args) {
+    return line->kind == ASM_INSTR && line->num_args == num_args && strcmp(line->op, op) == 0;
+}
+
+// match text to a letter then suffix, binding the letter to what is before
+// the suffix, or checking it against what it is already bound to
+static int peep_bind(char **v, char var, char *text, char *suffix) {
+    int len = strlen(text) - strlen(suffix);
+    if (len < 0 || strcmp(text + len, suffix) != 0) return 0;
+
+    char **bound = &v[var - 'A'];
+    if (*bound) return (int)strlen(*bound) == len && strncmp(*bound, text, len) == 0;
+    *bound = arena_sprintf(&func_arena, "%.*s", len, text);
+    return 1;
+}
+
+// whether text is a number, for the letters a replacement adds up
+static int peep_is_num(char *text) {
+    if (*text == '-') text++;
+    if (!*text) return 0;
+    for (; *text; text++) {
+        if (!isdigit(*text)) return 0;
+    } return 1;
+}
+
+#include "peep_table.h"
+
+// how often each rule has matched over the run
+static long long fired[PEEP_NUM_RULES];
+
+// whether the line is one the rules skip over
+static int skipped(AsmLine *line) {
+    return line->kind == ASM_TEXT || line->kind == ASM_NONE;
+}
+
+void peephole() {
+    AsmLine *window[PEEP_MAX_LINES];
+
+    for (int changed = 1; changed; ) {
+        changed = 0;
+        for (int i = 0; i < asm_code.count; i++) {
+            if (skipped(&asm_code.line[i])) continue;
+
+            // the lines from i on, as far as the longest pattern
+            int n = 0;
+            for (int j = i; j < asm_code.count && n < PEEP_MAX_LINES; j++) {
+                if (!skipped(&asm_code.line[j])) window[n++] = &asm_code.line[j];
+            }
+
+            for (int r = 0; r < PEEP_NUM_RULES; r++) {
+                if (peep_rules[r].match(window, n)) {
+                    fired[r]++;
+                    changed = 1;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// a table of how often each rule matched
+void print_peep_stats(FILE *out) {
+    fprintf(out, "%-16s %10s\n", "peephole rule", "fired");
+    for (int r = 0; r < PEEP_NUM_RULES; r++) {
+        fprintf(out, "%-16s %10lld\n", peep_rules[r].name, fired[r]);
+    }
+}
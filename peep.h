@@ -0,0 +1,24 @@
+/*
+ * File: peep.h
+ * Author: Maria Fay Garcia
+ * Purpose: To outline the peephole pass, which rewrites the mips code of
+ *          each function by the rules of peep.rules before it is printed
+ */
+#ifndef __PEEP_H__
+#define __PEEP_H__
+
+#include <stdio.h>
+#include "asm.h"
+
+// a rule, as peep_gen lays it out in peep_table.h: its matcher takes the
+// next n lines of the code, and rewrites them if they match
+typedef struct {
+    char  *name;
+    int  (*match)(AsmLine **m, int n);
+} PeepRule;
+
+// function stubs
+void     peephole         (                      );
+void     print_peep_stats (FILE           *out);
+
+#endif  /* __PEEP_H__ */
@@ -0,0 +1,346 @@
+/*
+ * File: peep_gen.c
+ * Author: Maria Fay Garcia
+ * Purpose: Compile the rules of the peephole pass into a C matcher for
+ *          each.  Run at build time: ./peep_gen peep.rules > peep_table.h
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define MAX_LINES  4
+#define MAX_ARGS   3
+#define MAX_TERMS  4
+
+// an operand of a rule: literal text, terms added up, then literal text
+// an operand with no terms is all text; one with a single letter and no
+// sign stands for text, not a number, and only it may have a prefix
+typedef struct {
+    char *prefix;
+    int   num_terms;
+    char  term_var[MAX_TERMS];  // the letter, or 0 for a number
+    int   term_num[MAX_TERMS];
+    int   term_neg[MAX_TERMS];
+    char *text;
+    char *source;               // the operand as written
+} Opnd;
+
+typedef struct {
+    int   is_label;
+    char *op;                   // or the label
+    Opnd  args[MAX_ARGS];
+    int   num_args;
+} Line;
+
+typedef struct {
+    char *name;
+    char *source;
+    Line  pat[MAX_LINES];
+    int   num_pat;
+    Line  rep[MAX_LINES];
+    int   num_rep;
+} Rule;
+
+static Rule rules[64];
+static int  num_rules = 0;
+static int  line_num  = 0;
+
+static void fail(char *msg) {
+    fprintf(stderr, "peep_gen: line %d: %s\n", line_num, msg);
+    exit(1);
+}
+
+static char *trim(char *s) {
+    while (isspace(*s)) s++;
+    char *end = s + strlen(s);
+    while (end > s && isspace(end[-1])) *--end = 0;
+    return s;
+}
+
+static int is_var(char *s) {
+    return isupper(s[0]) && !isalnum(s[1]);
+}
+
+static void parse_opnd(Opnd *opnd, char *s) {
+    opnd->source    = strdup(s);
+    opnd->num_terms = 0;
+
+    // text before a letter, as in _X for a global
+    char *t = s;
+    while (*t && !isupper(*t) && !isdigit(*t) && *t != '-') t++;
+    opnd->prefix = strndup(s, t - s);
+    if (t > s && is_var(t)) {
+        s = t;
+    } else {
+        opnd->prefix[0] = 0;
+    }
+
+    while (1) {
+        int neg = 0;
+        char *t = s;
+        if (opnd->num_terms > 0) {
+            if (*t != '+' && *t != '-') break;
+            neg = *t++ == '-';
+        } else if (*t == '-' && isdigit(t[1])) {
+            neg = 1;
+            t++;
+        }
+
+        if (is_var(t)) {
+            opnd->term_var[opnd->num_terms] = *t;
+            opnd->term_num[opnd->num_terms] = 0;
+            s = t + 1;
+        } else if (isdigit(*t)) {
+            opnd->term_var[opnd->num_terms] = 0;
+            opnd->term_num[opnd->num_terms] = strtol(t, &s, 10);
+        } else {
+            break;
+        }
+
+        opnd->term_neg[opnd->num_terms] = neg;
+        if (++opnd->num_terms == MAX_TERMS) fail("too many terms");
+    } opnd->text = strdup(s);
+
+    if (opnd->prefix[0] && opnd->num_terms != 1) fail("only a letter may follow text");
+}
+
+// whether the operand is a letter standing for text
+static int is_text_var(Opnd *opnd) {
+    return opnd->num_terms == 1 && opnd->term_var[0] && !opnd->term_neg[0];
+}
+
+// whether the operand has no letters, so is just the text it is written as
+static int is_literal(Opnd *opnd) {
+    for (int t = 0; t < opnd->num_terms; t++) {
+        if (opnd->term_var[t]) return 0;
+    } return 1;
+}
+
+static int parse_lines(Line *lines, char *s) {
+    int n = 0;
+    for (char *part = strtok(s, ";"); part; part = strtok(NULL, ";")) {
+        part = trim(part);
+        if (!*part) continue;
+        if (n == MAX_LINES) fail("too many lines");
+
+        Line *line = &lines[n++];
+        int len = strlen(part);
+        if (part[len - 1] == ':') {
+            part[len - 1] = 0;
+            line->is_label = 1;
+            parse_opnd(&line->args[0], part);
+            continue;
+        }
+
+        char *rest = part;
+        while (*rest && !isspace(*rest)) rest++;
+        if (*rest) *rest++ = 0;
+        line->op = strdup(part);
+
+        line->num_args = 0;
+        for (char *arg = strtok_r(rest, ",", &rest); arg; arg = strtok_r(NULL, ",", &rest)) {
+            if (line->num_args == MAX_ARGS) fail("too many operands");
+            parse_opnd(&line->args[line->num_args++], trim(arg));
+        }
+    } return n;
+}
+
+static void read_rules(FILE *in) {
+    char buf[512];
+    while (fgets(buf, sizeof(buf), in)) {
+        line_num++;
+        char *s = trim(buf);
+        if (!*s || *s == '#') continue;
+
+        Rule *rule = &rules[num_rules++];
+        rule->source = strdup(s);
+
+        char *colon = strchr(s, ':');
+        char *arrow = strstr(s, "=>");
+        if (!colon || !arrow || colon > arrow) fail("expected name: pattern => replacement");
+        *colon = 0;
+        *arrow = 0;
+        rule->name = strdup(trim(s));
+
+        rule->num_pat = parse_lines(rule->pat, colon + 1);
+        rule->num_rep = parse_lines(rule->rep, arrow + 2);
+        if (rule->num_pat == 0) fail("empty pattern");
+        if (rule->num_rep > rule->num_pat) fail("a replacement longer than its pattern");
+    }
+}
+
+
+/*************** OUTPUT *****************/
+
+static void print_c_string(char *s) {
+    putchar('"');
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') putchar('\\');
+        putchar(*s);
+    } putchar('"');
+}
+
+// the tests that the text of line k, operand (or label) a, matches opnd
+static void print_opnd_match(Opnd *opnd, char *text) {
+    if (is_literal(opnd)) {
+        printf("    if (strcmp(%s, ", text);
+        print_c_string(opnd->source);
+        printf(") != 0) return 0;\n");
+        return;
+    } else if (!is_text_var(opnd)) {
+        fail("a pattern operand may only be a letter and text");
+    }
+
+    int skip = strlen(opnd->prefix);
+    if (skip) {
+        printf("    if (strncmp(%s, ", text);
+        print_c_string(opnd->prefix);
+        printf(", %d) != 0) return 0;\n", skip);
+    }
+    printf("    if (!peep_bind(v, '%c', %s", opnd->term_var[0], text);
+    if (skip) printf(" + %d", skip);
+    printf(", ");
+    print_c_string(opnd->text);
+    printf(")) return 0;\n");
+}
+
+// the C expression for a replacement operand
+static void print_opnd_value(Opnd *opnd) {
+    if (is_literal(opnd)) {
+        print_c_string(opnd->source);
+        return;
+    } else if (is_text_var(opnd) && !opnd->prefix[0] && !opnd->text[0]) {
+        printf("v['%c' - 'A']", opnd->term_var[0]);
+        return;
+    } else if (is_text_var(opnd)) {
+        printf("arena_sprintf(&func_arena, \"%%s%%s%%s\", ");
+        print_c_string(opnd->prefix);
+        printf(", v['%c' - 'A'], ", opnd->term_var[0]);
+        print_c_string(opnd->text);
+        printf(")");
+        return;
+    }
+
+    printf("arena_sprintf(&func_arena, \"%%d%%s\", 0");
+    for (int t = 0; t < opnd->num_terms; t++) {
+        printf(" %c ", opnd->term_neg[t] ? '-' : '+');
+        if (opnd->term_var[t]) {
+            printf("atoi(v['%c' - 'A'])", opnd->term_var[t]);
+        } else {
+            printf("%d", opnd->term_num[t]);
+        }
+    } printf(", ");
+    print_c_string(opnd->text);
+    printf(")");
+}
+
+static void print_rule(int r) {
+    Rule *rule = &rules[r];
+    printf("// %s\n", rule->source);
+    printf("static int peep_%s(AsmLine **m, int n) {\n", rule->name);
+    // the letters bound, if the pattern has any
+    int has_vars = 0;
+    for (int k = 0; k < rule->num_pat; k++) {
+        Line *line = &rule->pat[k];
+        for (int a = 0; a < (line->is_label ? 1 : line->num_args); a++) {
+            has_vars |= !is_literal(&line->args[a]);
+        }
+    }
+    if (has_vars) printf("    char *v[26] = { 0 };\n");
+    printf("    if (n < %d) return 0;\n", rule->num_pat);
+
+    for (int k = 0; k < rule->num_pat; k++) {
+        Line *line = &rule->pat[k];
+        char  text[64];
+        if (line->is_label) {
+            printf("    if (m[%d]->kind != ASM_LABEL) return 0;\n", k);
+            sprintf(text, "m[%d]->op", k);
+            print_opnd_match(&line->args[0], text);
+            continue;
+        }
+
+        printf("    if (!peep_instr(m[%d], ", k);
+        print_c_string(line->op);
+        printf(", %d)) return 0;\n", line->num_args);
+        for (int a = 0; a < line->num_args; a++) {
+            sprintf(text, "m[%d]->arg[%d]", k, a);
+            print_opnd_match(&line->args[a], text);
+        }
+    }
+
+    // the letters added up must be numbers
+    int checked[26] = { 0 };
+    for (int k = 0; k < rule->num_rep; k++) {
+        Line *line = &rule->rep[k];
+        for (int a = 0; a < (line->is_label ? 1 : line->num_args); a++) {
+            Opnd *opnd = &line->args[a];
+            if (is_text_var(opnd)) continue;
+            for (int t = 0; t < opnd->num_terms; t++) {
+                int var = opnd->term_var[t];
+                if (!var || checked[var - 'A']++) continue;
+                printf("    if (!peep_is_num(v['%c' - 'A'])) return 0;\n", var);
+            }
+        }
+    }
+
+    printf("\n");
+    for (int k = 0; k < rule->num_rep; k++) {
+        Line *line = &rule->rep[k];
+        if (line->is_label) {
+            printf("    set_asm_line(m[%d], ASM_LABEL, ", k);
+            print_opnd_value(&line->args[0]);
+            printf(", 0, NULL);\n");
+            continue;
+        }
+
+        printf("    {\n");
+        printf("        char *args[%d] = { ", MAX_ARGS);
+        for (int a = 0; a < line->num_args; a++) {
+            if (a) printf(", ");
+            print_opnd_value(&line->args[a]);
+        } if (line->num_args == 0) printf("NULL");
+        printf(" };\n");
+        printf("        set_asm_line(m[%d], ASM_INSTR, ", k);
+        print_c_string(line->op);
+        printf(", %d, args);\n", line->num_args);
+        printf("    }\n");
+    }
+    for (int k = rule->num_rep; k < rule->num_pat; k++) {
+        printf("    m[%d]->kind = ASM_NONE;\n", k);
+    }
+    printf("    return 1;\n");
+    printf("}\n\n");
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: peep_gen rules\n");
+        return 1;
+    }
+    FILE *in = fopen(argv[1], "r");
+    if (!in) {
+        perror(argv[1]);
+        return 1;
+    }
+    read_rules(in);
+    fclose(in);
+
+    printf("/* generated by peep_gen from %s -- do not edit */\n\n", argv[1]);
+
+    int max_lines = 0;
+    for (int r = 0; r < num_rules; r++) {
+        if (rules[r].num_pat > max_lines) max_lines = rules[r].num_pat;
+    }
+    printf("#define PEEP_NUM_RULES %d\n", num_rules);
+    printf("#define PEEP_MAX_LINES %d\n\n", max_lines);
+
+    for (int r = 0; r < num_rules; r++) print_rule(r);
+
+    printf("static const PeepRule peep_rules[PEEP_NUM_RULES] = {\n");
+    for (int r = 0; r < num_rules; r++) {
+        printf("    { \"%s\", peep_%s },\n", rules[r].name, rules[r].name);
+    } printf("};\n");
+
+    return 0;
+}
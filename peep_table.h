@@ -0,0 +1,213 @@
+/* generated by peep_gen from peep.rules -- do not edit */
+
+#define PEEP_NUM_RULES 10
+#define PEEP_MAX_LINES 2
+
+// jump_next:       j L ; L:                           => L:
+static int peep_jump_next(AsmLine **m, int n) {
+    char *v[26] = { 0 };
+    if (n < 2) return 0;
+    if (!peep_instr(m[0], "j", 1)) return 0;
+    if (!peep_bind(v, 'L', m[0]->arg[0], "")) return 0;
+    if (m[1]->kind != ASM_LABEL) return 0;
+    if (!peep_bind(v, 'L', m[1]->op, "")) return 0;
+
+    set_asm_line(m[0], ASM_LABEL, v['L' - 'A'], 0, NULL);
+    m[1]->kind = ASM_NONE;
+    return 1;
+}
+
+// store_load:      sw A, X ; lw A, X                  => sw A, X
+static int peep_store_load(AsmLine **m, int n) {
+    char *v[26] = { 0 };
+    if (n < 2) return 0;
+    if (!peep_instr(m[0], "sw", 2)) return 0;
+    if (!peep_bind(v, 'A', m[0]->arg[0], "")) return 0;
+    if (!peep_bind(v, 'X', m[0]->arg[1], "")) return 0;
+    if (!peep_instr(m[1], "lw", 2)) return 0;
+    if (!peep_bind(v, 'A', m[1]->arg[0], "")) return 0;
+    if (!peep_bind(v, 'X', m[1]->arg[1], "")) return 0;
+
+    {
+        char *args[3] = { v['A' - 'A'], v['X' - 'A'] };
+        set_asm_line(m[0], ASM_INSTR, "sw", 2, args);
+    }
+    m[1]->kind = ASM_NONE;
+    return 1;
+}
+
+// store_load_move: sw A, X ; lw B, X                  => sw A, X ; move B, A
+static int peep_store_load_move(AsmLine **m, int n) {
+    char *v[26] = { 0 };
+    if (n < 2) return 0;
+    if (!peep_instr(m[0], "sw", 2)) return 0;
+    if (!peep_bind(v, 'A', m[0]->arg[0], "")) return 0;
+    if (!peep_bind(v, 'X', m[0]->arg[1], "")) return 0;
+    if (!peep_instr(m[1], "lw", 2)) return 0;
+    if (!peep_bind(v, 'B', m[1]->arg[0], "")) return 0;
+    if (!peep_bind(v, 'X', m[1]->arg[1], "")) return 0;
+
+    {
+        char *args[3] = { v['A' - 'A'], v['X' - 'A'] };
+        set_asm_line(m[0], ASM_INSTR, "sw", 2, args);
+    }
+    {
+        char *args[3] = { v['B' - 'A'], v['A' - 'A'] };
+        set_asm_line(m[1], ASM_INSTR, "move", 2, args);
+    }
+    return 1;
+}
+
+// load_store:      lw A, X ; sw A, X                  => lw A, X
+static int peep_load_store(AsmLine **m, int n) {
+    char *v[26] = { 0 };
+    if (n < 2) return 0;
+    if (!peep_instr(m[0], "lw", 2)) return 0;
+    if (!peep_bind(v, 'A', m[0]->arg[0], "")) return 0;
+    if (!peep_bind(v, 'X', m[0]->arg[1], "")) return 0;
+    if (!peep_instr(m[1], "sw", 2)) return 0;
+    if (!peep_bind(v, 'A', m[1]->arg[0], "")) return 0;
+    if (!peep_bind(v, 'X', m[1]->arg[1], "")) return 0;
+
+    {
+        char *args[3] = { v['A' - 'A'], v['X' - 'A'] };
+        set_asm_line(m[0], ASM_INSTR, "lw", 2, args);
+    }
+    m[1]->kind = ASM_NONE;
+    return 1;
+}
+
+// push_li:         li A, C ; la $sp, -4($sp)          => la $sp, -4($sp) ; li A, C
+static int peep_push_li(AsmLine **m, int n) {
+    char *v[26] = { 0 };
+    if (n < 2) return 0;
+    if (!peep_instr(m[0], "li", 2)) return 0;
+    if (!peep_bind(v, 'A', m[0]->arg[0], "")) return 0;
+    if (!peep_bind(v, 'C', m[0]->arg[1], "")) return 0;
+    if (!peep_instr(m[1], "la", 2)) return 0;
+    if (strcmp(m[1]->arg[0], "$sp") != 0) return 0;
+    if (strcmp(m[1]->arg[1], "-4($sp)") != 0) return 0;
+
+    {
+        char *args[3] = { "$sp", "-4($sp)" };
+        set_asm_line(m[0], ASM_INSTR, "la", 2, args);
+    }
+    {
+        char *args[3] = { v['A' - 'A'], v['C' - 'A'] };
+        set_asm_line(m[1], ASM_INSTR, "li", 2, args);
+    }
+    return 1;
+}
+
+// push_lw_local:   lw A, X($fp) ; la $sp, -4($sp)     => la $sp, -4($sp) ; lw A, X($fp)
+static int peep_push_lw_local(AsmLine **m, int n) {
+    char *v[26] = { 0 };
+    if (n < 2) return 0;
+    if (!peep_instr(m[0], "lw", 2)) return 0;
+    if (!peep_bind(v, 'A', m[0]->arg[0], "")) return 0;
+    if (!peep_bind(v, 'X', m[0]->arg[1], "($fp)")) return 0;
+    if (!peep_instr(m[1], "la", 2)) return 0;
+    if (strcmp(m[1]->arg[0], "$sp") != 0) return 0;
+    if (strcmp(m[1]->arg[1], "-4($sp)") != 0) return 0;
+
+    {
+        char *args[3] = { "$sp", "-4($sp)" };
+        set_asm_line(m[0], ASM_INSTR, "la", 2, args);
+    }
+    {
+        char *args[3] = { v['A' - 'A'], arena_sprintf(&func_arena, "%s%s%s", "", v['X' - 'A'], "($fp)") };
+        set_asm_line(m[1], ASM_INSTR, "lw", 2, args);
+    }
+    return 1;
+}
+
+// push_lw_global:  lw A, _X ; la $sp, -4($sp)         => la $sp, -4($sp) ; lw A, _X
+static int peep_push_lw_global(AsmLine **m, int n) {
+    char *v[26] = { 0 };
+    if (n < 2) return 0;
+    if (!peep_instr(m[0], "lw", 2)) return 0;
+    if (!peep_bind(v, 'A', m[0]->arg[0], "")) return 0;
+    if (strncmp(m[0]->arg[1], "_", 1) != 0) return 0;
+    if (!peep_bind(v, 'X', m[0]->arg[1] + 1, "")) return 0;
+    if (!peep_instr(m[1], "la", 2)) return 0;
+    if (strcmp(m[1]->arg[0], "$sp") != 0) return 0;
+    if (strcmp(m[1]->arg[1], "-4($sp)") != 0) return 0;
+
+    {
+        char *args[3] = { "$sp", "-4($sp)" };
+        set_asm_line(m[0], ASM_INSTR, "la", 2, args);
+    }
+    {
+        char *args[3] = { v['A' - 'A'], arena_sprintf(&func_arena, "%s%s%s", "_", v['X' - 'A'], "") };
+        set_asm_line(m[1], ASM_INSTR, "lw", 2, args);
+    }
+    return 1;
+}
+
+// push_store:      sw A, K($sp) ; la $sp, -4($sp)     => la $sp, -4($sp) ; sw A, K+4($sp)
+static int peep_push_store(AsmLine **m, int n) {
+    char *v[26] = { 0 };
+    if (n < 2) return 0;
+    if (!peep_instr(m[0], "sw", 2)) return 0;
+    if (!peep_bind(v, 'A', m[0]->arg[0], "")) return 0;
+    if (!peep_bind(v, 'K', m[0]->arg[1], "($sp)")) return 0;
+    if (!peep_instr(m[1], "la", 2)) return 0;
+    if (strcmp(m[1]->arg[0], "$sp") != 0) return 0;
+    if (strcmp(m[1]->arg[1], "-4($sp)") != 0) return 0;
+    if (!peep_is_num(v['K' - 'A'])) return 0;
+
+    {
+        char *args[3] = { "$sp", "-4($sp)" };
+        set_asm_line(m[0], ASM_INSTR, "la", 2, args);
+    }
+    {
+        char *args[3] = { v['A' - 'A'], arena_sprintf(&func_arena, "%d%s", 0 + atoi(v['K' - 'A']) + 4, "($sp)") };
+        set_asm_line(m[1], ASM_INSTR, "sw", 2, args);
+    }
+    return 1;
+}
+
+// push_push:       la $sp, N($sp) ; la $sp, M($sp)    => la $sp, N+M($sp)
+static int peep_push_push(AsmLine **m, int n) {
+    char *v[26] = { 0 };
+    if (n < 2) return 0;
+    if (!peep_instr(m[0], "la", 2)) return 0;
+    if (strcmp(m[0]->arg[0], "$sp") != 0) return 0;
+    if (!peep_bind(v, 'N', m[0]->arg[1], "($sp)")) return 0;
+    if (!peep_instr(m[1], "la", 2)) return 0;
+    if (strcmp(m[1]->arg[0], "$sp") != 0) return 0;
+    if (!peep_bind(v, 'M', m[1]->arg[1], "($sp)")) return 0;
+    if (!peep_is_num(v['N' - 'A'])) return 0;
+    if (!peep_is_num(v['M' - 'A'])) return 0;
+
+    {
+        char *args[3] = { "$sp", arena_sprintf(&func_arena, "%d%s", 0 + atoi(v['N' - 'A']) + atoi(v['M' - 'A']), "($sp)") };
+        set_asm_line(m[0], ASM_INSTR, "la", 2, args);
+    }
+    m[1]->kind = ASM_NONE;
+    return 1;
+}
+
+// push_zero:       la $sp, 0($sp)                     =>
+static int peep_push_zero(AsmLine **m, int n) {
+    if (n < 1) return 0;
+    if (!peep_instr(m[0], "la", 2)) return 0;
+    if (strcmp(m[0]->arg[0], "$sp") != 0) return 0;
+    if (strcmp(m[0]->arg[1], "0($sp)") != 0) return 0;
+
+    m[0]->kind = ASM_NONE;
+    return 1;
+}
+
+static const PeepRule peep_rules[PEEP_NUM_RULES] = {
+    { "jump_next", peep_jump_next },
+    { "store_load", peep_store_load },
+    { "store_load_move", peep_store_load_move },
+    { "load_store", peep_load_store },
+    { "push_li", peep_push_li },
+    { "push_lw_local", peep_push_lw_local },
+    { "push_lw_global", peep_push_lw_global },
+    { "push_store", peep_push_store },
+    { "push_push", peep_push_push },
+    { "push_zero", peep_push_zero },
+};
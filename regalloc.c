@@ -0,0 +1,650 @@
+/*
+ * File: regalloc.c
+ * Author: Maria Fay Garcia
+ * Purpose: Linear scan register allocation over the three address code
+ *          of a function, once the optimization passes are done with it,
+ *          and the sharing of stack slots between values live apart
+ */
+#include <limits.h>
+#include "regalloc.h"
+#include "opt.h"
+#include "dataflow.h"
+#include "pass.h"
+#include "arena.h"
+
+char *reg_name[32] = {
+    "$zero", "$at", "$v0", "$v1", "$a0", "$a1", "$a2", "$a3",
+    "$t0",   "$t1", "$t2", "$t3", "$t4", "$t5", "$t6", "$t7",
+    "$s0",   "$s1", "$s2", "$s3", "$s4", "$s5", "$s6", "$s7",
+    "$t8",   "$t9", "$k0", "$k1", "$gp", "$sp", "$fp", "$ra"
+};
+
+// the registers given out: a call may clobber the caller-saved ones,
+// so only values that are not live across one may have them
+static int caller_saved[] = { 10, 11, 12, 13, 14, 15, 24, 25 };
+static int callee_saved[] = { 16, 17, 18, 19, 20, 21, 22, 23 };
+
+#define NUM_TREGS ((int)(sizeof(caller_saved) / sizeof(caller_saved[0])))
+
+int   saved_regs[NUM_SREGS];
+int   num_saved_regs = 0;
+
+symtab_entry **entry_loads;
+int        num_entry_loads = 0;
+
+/*
+ * The values are the locals and params, by the numbers number_vars gave
+ * them, then the temps, temp t at num_vars + t.  Globals stay in memory,
+ * since a call may read or set them.  Instr i reads its operands at
+ * point 2i and sets its dest at 2i + 1, so a value read for the last
+ * time by an instr may share a register with the one it sets.
+ */
+static int     ra_valid = 0;    // whether the registers are the current function's
+static int     iv_valid = 0;    // and the intervals
+static int     ra_vars;
+static int     ra_temps;
+static int    *reg_of;          // each value's register, -1 if it lives in memory
+static char   *remat;           // the temps left in memory that are only ever a constant
+static int    *remat_val;
+static int     slots_valid = 0; // whether the stack slots are shared, see share_stack_slots
+static int    *slot_of;         // each temp's slot
+static int     num_slots;
+
+// the value op names, -1 if it is not one that may get a register
+static int value_of(Operand op) {
+    if (OPND_TYPE(op) == TEMP) return num_vars + OPND_INT(op);
+
+    int var = named_var(op);
+    if (var < 0 || vars[var]->scope != LOCAL) return -1;
+    return var;
+}
+
+// the register op is kept in, -1 if it lives in memory
+int operand_reg(Operand op) {
+    if (!ra_valid) return -1;
+    if (OPND_TYPE(op) == TEMP) {
+        int t = OPND_INT(op);
+        return t < ra_temps ? reg_of[ra_vars + t] : -1;
+    }
+
+    int var = named_var(op);
+    return var >= 0 && var < ra_vars ? reg_of[var] : -1;
+}
+
+// whether op is a temp left in memory that is only ever the constant
+// *val, so it is made where it is read instead of stored and loaded
+int remat_const(Operand op, int *val) {
+    if (!ra_valid || OPND_TYPE(op) != TEMP) return 0;
+
+    int t = OPND_INT(op);
+    if (t >= ra_temps || !remat[t] || reg_of[ra_vars + t] >= 0) return 0;
+    *val = remat_val[t];
+    return 1;
+}
+
+// forget the last function's registers and slots, everything lives
+// in memory, in the slots it was given when it was made
+void clear_registers() {
+    ra_valid        = 0;
+    iv_valid        = 0;
+    slots_valid     = 0;
+    num_saved_regs  = 0;
+    num_entry_loads = 0;
+}
+
+
+/*************** CLOBBERS *****************/
+
+/*
+ * A call may change the registers its callee, or anything the callee
+ * calls, writes and does not restore.  A function may only call those
+ * declared before it, and itself, so by the time a function is
+ * allocated every function it calls but itself has been compiled and
+ * has left what it changes on its symbol table entry.
+ */
+
+// what any function changes: $at (pseudo instructions), $v0 and the
+// registers translation loads what is in memory into
+#define SCRATCH_REGS (REG_BIT(1) | REG_BIT(2) | REG_BIT(REG_T0) | REG_BIT(REG_T1))
+
+// the registers a call may change
+// println's are put on its entry when the parser adds it
+RegSet call_clobbers(Instr *call) {
+    symtab_entry *callee = OPND_ENTRY(call->src1);
+    return callee->clobbers_known ? callee->clobbers : ~0u;
+}
+
+// leave what a call to the function being compiled may change on its
+// entry, for the functions compiled after it
+// a call to itself changes nothing it does not change anyway
+void record_clobbers() {
+    if (ir.count == 0 || ir.instr[0].op != OP_ENTER) return;
+    symtab_entry *func = OPND_ENTRY(ir.instr[0].dest);
+
+    RegSet clob = SCRATCH_REGS;
+    if (ra_valid) {
+        for (int v = 0; v < ra_vars + ra_temps; v++) {
+            if (reg_of[v] >= 0) clob |= REG_BIT(reg_of[v]);
+        }
+    }
+    for (int i = 0; i < ir.count; i++) {
+        if (ir.instr[i].op != OP_CALL || OPND_ENTRY(ir.instr[i].src1) == func) continue;
+        clob |= call_clobbers(&ir.instr[i]);
+    }
+
+    // the callee-saved registers are put back before it returns
+    for (int k = 0; k < NUM_SREGS; k++) clob &= ~REG_BIT(callee_saved[k]);
+    func->clobbers       = clob;
+    func->clobbers_known = 1;
+}
+
+
+/*************** LIVE INTERVALS *****************/
+
+static int    *start;           // the first and last point each value is live at
+static int    *end;
+static double *weight;          // its uses and defs, weighted by loop depth but at -Os
+static char   *no_reg;          // the values whose intervals are not known
+static BitWord *live_in;        // the variables live into the function, NULL if not known
+
+static void extend(int v, int point) {
+    if (point < start[v]) start[v] = point;
+    if (point > end[v])   end[v]   = point;
+}
+
+// how deep in loops each instr is: the code of a loop runs from the
+// label its back edge jumps to down to the back edge
+static int *loop_depth() {
+    int *depth = (int *)arena_alloc(&func_arena, (ir.count + 2) * sizeof(int));
+    for (int i = 0; i < ir.count; i++) {
+        Instr *instr = &ir.instr[i];
+        if (instr->op != OP_GOTO && !is_cond_branch(instr->op)) continue;
+
+        int b = label_block(OPND_INT(instr->dest));
+        if (b < 0 || cfg.block[b].first > i) continue;
+        depth[cfg.block[b].first]++;
+        depth[i + 1]--;
+    }
+
+    for (int i = 1; i < ir.count; i++) depth[i] += depth[i - 1];
+    return depth;
+}
+
+// what a use or def at a loop depth is taken to cost
+// at -Os it is the one load or store however often it runs
+static double depth_weight(int depth) {
+    if (opt_level == OPT_OS) return 1;
+
+    double w = 1;
+    for (int d = 0; d < depth && d < 8; d++) w *= 10;
+    return w;
+}
+
+/*
+ * A variable is live from the top of each block it is live into to the
+ * bottom of each block it is live out of, and at each of its uses and
+ * defs; its interval runs from the first of these points to the last.
+ * A temp lives in one block, from its def to its last use.  Without the
+ * liveness (too large a function) the variables all stay in memory, and
+ * a value whose interval is not known is taken to live throughout.
+ */
+static void find_intervals() {
+    int n = num_vars + tmp_num;
+    for (int v = 0; v < n; v++) {
+        start[v] = INT_MAX;
+        end[v]   = -1;
+    }
+    for (int g = 0; g < num_global_vars; g++) no_reg[global_vars[g]] = 1;
+
+    Dataflow live;
+    if (live_vars(&live)) {
+        for (int b = 0; b < cfg.count; b++) {
+            Block *block = &cfg.block[b];
+            BitWord *in  = DF_SET(&live, in, b);
+            BitWord *out = DF_SET(&live, out, b);
+            for (int w = 0; w < live.words; w++) {
+                for (BitWord bits = in[w]; bits; bits &= bits - 1) {
+                    extend(w * 64 + __builtin_ctzll(bits), 2 * block->first);
+                }
+                for (BitWord bits = out[w]; bits; bits &= bits - 1) {
+                    extend(w * 64 + __builtin_ctzll(bits), 2 * block->end - 1);
+                }
+            }
+        } live_in = DF_SET(&live, in, 0);
+    } else {
+        for (int v = 0; v < num_vars; v++) no_reg[v] = 1;
+        live_in = NULL;
+    }
+
+    // the block each temp is set in
+    int *def_block = (int *)arena_alloc(&func_arena, (tmp_num + 1) * sizeof(int));
+    int *depth     = loop_depth();
+    for (int t = 0; t < tmp_num; t++) def_block[t] = -1;
+
+    for (int b = 0; b < cfg.count; b++) {
+        for (int i = cfg.block[b].first; i < cfg.block[b].end; i++) {
+            Instr *instr = &ir.instr[i];
+            if (instr->op == OP_CALL) continue;
+
+            double w = depth_weight(depth[i]);
+            Operand srcs[2] = { instr->src1, instr->src2 };
+            for (int k = 0; k < 2; k++) {
+                int v = value_of(srcs[k]);
+                if (v < 0) continue;
+                if (OPND_TYPE(srcs[k]) == TEMP && def_block[OPND_INT(srcs[k])] != b) no_reg[v] = 1;
+                extend(v, 2 * i);
+                weight[v] += w;
+            }
+
+            int v = value_of(instr->dest);
+            if (v < 0) continue;
+            if (OPND_TYPE(instr->dest) == TEMP) {
+                int t = OPND_INT(instr->dest);
+                if (def_block[t] >= 0) {
+                    no_reg[v] = 1;
+                    remat[t]  = 0;
+                }
+                def_block[t] = b;
+
+                // a constant is as cheap to make again as to load
+                if (!no_reg[v] && instr->op == OP_ASSG && OPND_TYPE(instr->src1) == ICONST) {
+                    remat[t]     = 1;
+                    remat_val[t] = OPND_INT(instr->src1);
+                }
+            }
+            extend(v, 2 * i + 1);
+            weight[v] += w;
+        }
+    }
+
+    for (int t = 0; t < tmp_num; t++) {
+        if (remat[t]) weight[num_vars + t] /= 2;
+    }
+    for (int v = 0; v < n; v++) {
+        if (no_reg[v] && end[v] >= 0) {
+            start[v] = 0;
+            end[v]   = INT_MAX;
+        }
+    }
+}
+
+// find the intervals of the function, if no pass has yet
+// returns 0 if it has no code
+static int build_intervals() {
+    if (iv_valid) return 1;
+    number_vars();
+    build_cfg();
+    if (cfg.count == 0) return 0;
+
+    int n = num_vars + tmp_num;
+    ra_vars   = num_vars;
+    ra_temps  = tmp_num;
+    start     = (int *)arena_alloc(&func_arena, (n + 1) * sizeof(int));
+    end       = (int *)arena_alloc(&func_arena, (n + 1) * sizeof(int));
+    weight    = (double *)arena_alloc(&func_arena, (n + 1) * sizeof(double));
+    no_reg    = (char *)arena_alloc(&func_arena, n + 1);
+    remat     = (char *)arena_alloc(&func_arena, tmp_num + 1);
+    remat_val = (int *)arena_alloc(&func_arena, (tmp_num + 1) * sizeof(int));
+    find_intervals();
+
+    iv_valid = 1;
+    return 1;
+}
+
+
+/*************** LINEAR SCAN *****************/
+
+static int *calls;              // the instrs that are calls, in order
+static int  num_calls;
+
+/*
+ * What each call may change is kept in a sparse table: row j holds the
+ * registers calls k .. k + 2^j - 1 may change, so those of any run of
+ * calls are two rows' words or'd together.
+ */
+static RegSet **clob_rows;
+
+static void build_clob_rows() {
+    int levels = 1;
+    while ((1 << levels) <= num_calls) levels++;
+
+    clob_rows = (RegSet **)arena_alloc(&func_arena, levels * sizeof(RegSet *));
+    for (int j = 0; j < levels; j++) {
+        clob_rows[j] = (RegSet *)arena_alloc(&func_arena, (num_calls + 1) * sizeof(RegSet));
+    }
+
+    for (int k = 0; k < num_calls; k++) clob_rows[0][k] = call_clobbers(&ir.instr[calls[k]]);
+    for (int j = 1; j < levels; j++) {
+        for (int k = 0; k + (1 << j) <= num_calls; k++) {
+            clob_rows[j][k] = clob_rows[j - 1][k] | clob_rows[j - 1][k + (1 << (j - 1))];
+        }
+    }
+}
+
+// the first call at or after point
+static int call_at(int point) {
+    int lo = 0, hi = num_calls;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (2 * calls[mid] < point) lo = mid + 1;
+        else hi = mid;
+    } return lo;
+}
+
+// the registers the calls between the first and last point of an
+// interval may change, 0 if it is not live across a call
+static RegSet calls_clobber(int from, int to) {
+    int first = call_at(from);
+    int last  = call_at(to) - 1;
+    if (first > last) return 0;
+
+    int j = 0;
+    while ((2 << j) <= last - first + 1) j++;
+    return clob_rows[j][first] | clob_rows[j][last - (1 << j) + 1];
+}
+
+// the values, in the order their intervals start
+static int *sort_start;
+
+static int by_start(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    if (sort_start[x] != sort_start[y]) return sort_start[x] < sort_start[y] ? -1 : 1;
+    return x - y;
+}
+
+// a register of regs, but for those in the mask clob, no interval
+// holds (owner NULL: any not in clob), -1 if none
+static int free_reg(int *regs, int count, int *owner, RegSet clob) {
+    for (int k = 0; k < count; k++) {
+        if ((!owner || owner[regs[k]] < 0) && !(clob & REG_BIT(regs[k]))) return regs[k];
+    } return -1;
+}
+
+// the register of regs, but for those in the mask clob, whose interval
+// costs least to leave in memory, -1 if none
+static int cheapest_reg(int *regs, int count, int *owner, RegSet clob) {
+    int best = -1;
+    for (int k = 0; k < count; k++) {
+        if (clob & REG_BIT(regs[k])) continue;
+        if (best < 0 || weight[owner[regs[k]]] < weight[owner[best]]) best = regs[k];
+    } return best;
+}
+
+// whether giving v register r saves more code than it adds, at -Os:
+// the load of a variable live into the function at its entry, and the
+// save and restore of a callee-saved register none has taken yet
+static int worth_reg(int v, int r, RegSet taken) {
+    if (opt_level != OPT_OS) return 1;
+
+    double cost = 0;
+    if (v < ra_vars && live_in && BIT_TEST(live_in, v)) cost += 1;
+    for (int k = 0; k < NUM_SREGS; k++) {
+        if (callee_saved[k] == r && !(taken & REG_BIT(r))) cost += 2;
+    } return weight[v] > cost;
+}
+
+/*
+ * The intervals are taken in the order they start.  Those that have
+ * ended give their registers back, then the interval takes a free one:
+ * a caller-saved one no call made while it is live may change, else a
+ * callee-saved one.  With none free, the interval costing least to keep
+ * in memory -- it or one holding a register it could use -- spills.
+ * At -Os a value only takes a register that makes the code smaller.
+ */
+void alloc_registers() {
+    if (!build_intervals()) return;
+
+    int n = ra_vars + ra_temps;
+    reg_of = (int *)arena_alloc(&func_arena, (n + 1) * sizeof(int));
+
+    calls = (int *)arena_alloc(&func_arena, (ir.count + 1) * sizeof(int));
+    num_calls = 0;
+    for (int i = 0; i < ir.count; i++) {
+        if (ir.instr[i].op == OP_CALL) calls[num_calls++] = i;
+    } build_clob_rows();
+
+    int *order = (int *)arena_alloc(&func_arena, (n + 1) * sizeof(int));
+    int  count = 0;
+    for (int v = 0; v < n; v++) {
+        reg_of[v] = -1;
+        if (end[v] >= 0 && !no_reg[v]) order[count++] = v;
+    }
+    sort_start = start;
+    qsort(order, count, sizeof(int), by_start);
+
+    int owner[32];
+    for (int r = 0; r < 32; r++) owner[r] = -1;
+    RegSet taken = 0;
+
+    for (int k = 0; k < count; k++) {
+        int v = order[k];
+
+        // the intervals that ended give their registers back
+        for (int r = 0; r < 32; r++) {
+            if (owner[r] >= 0 && end[owner[r]] < start[v]) owner[r] = -1;
+        }
+
+        RegSet clob = calls_clobber(start[v], end[v]);
+        int r = free_reg(caller_saved, NUM_TREGS, owner, clob);
+        if (r < 0) r = free_reg(callee_saved, NUM_SREGS, owner, 0);
+        if (r < 0) {
+            int s = cheapest_reg(callee_saved, NUM_SREGS, owner, 0);
+            int t = cheapest_reg(caller_saved, NUM_TREGS, owner, clob);
+            if (t >= 0 && weight[owner[t]] < weight[owner[s]]) s = t;
+
+            if (weight[owner[s]] >= weight[v] || !worth_reg(v, s, taken)) continue;
+            reg_of[owner[s]] = -1;
+            r = s;
+        } else if (!worth_reg(v, r, taken)) {
+            continue;
+        }
+
+        owner[r]  = v;
+        reg_of[v] = r;
+        taken    |= REG_BIT(r);
+    }
+
+    // the callee-saved registers in use, and the variables that come
+    // into the function in a register
+    char used[32] = {0};
+    entry_loads = (symtab_entry **)arena_alloc(&func_arena, (num_vars + 1) * sizeof(symtab_entry *));
+    for (int v = 0; v < n; v++) {
+        if (reg_of[v] < 0) continue;
+        used[reg_of[v]] = 1;
+        if (v < num_vars && live_in && BIT_TEST(live_in, v)) entry_loads[num_entry_loads++] = vars[v];
+    }
+    for (int k = 0; k < NUM_SREGS; k++) {
+        if (used[callee_saved[k]]) saved_regs[num_saved_regs++] = callee_saved[k];
+    }
+
+    // only the temps left in memory are made again where they are read
+    for (int t = 0; t < tmp_num; t++) {
+        if (reg_of[num_vars + t] >= 0 || no_reg[num_vars + t]) remat[t] = 0;
+    }
+
+    ra_valid = 1;
+}
+
+
+/*************** STACK SLOTS *****************/
+
+// the slot below $fp temp is kept in, slot k at -4(k+1)($fp)
+// without sharing the temps come after the locals, one slot each
+int temp_slot(int temp) {
+    if (slots_valid && temp < ra_temps) return slot_of[temp];
+    return frame_locals + temp;
+}
+
+// the number of slots the locals and temps take
+int frame_slots() {
+    return slots_valid ? num_slots : frame_locals + tmp_num;
+}
+
+// the intervals holding slots, a heap on where they end
+static int *heap_val;
+static int  heap_count;
+
+static void heap_push(int v) {
+    int k = heap_count++;
+    for (; k > 0 && end[heap_val[(k - 1) / 2]] > end[v]; k = (k - 1) / 2) {
+        heap_val[k] = heap_val[(k - 1) / 2];
+    } heap_val[k] = v;
+}
+
+static int heap_pop() {
+    int top  = heap_val[0];
+    int last = heap_val[--heap_count];
+    int k = 0;
+    for (;;) {
+        int kid = 2 * k + 1;
+        if (kid >= heap_count) break;
+        if (kid + 1 < heap_count && end[heap_val[kid + 1]] < end[heap_val[kid]]) kid++;
+        if (end[heap_val[kid]] >= end[last]) break;
+        heap_val[k] = heap_val[kid];
+        k = kid;
+    } heap_val[k] = last;
+    return top;
+}
+
+/*
+ * The locals and the temps left in memory share stack slots: taken in
+ * the order their intervals start, each takes a slot given back by an
+ * interval that has ended, or a new one.  Intervals overlap at most as
+ * many at a time as there are slots, so the frame is as small as the
+ * most values live at once.  A local given a register that is read
+ * before it is set still gets a slot for the prologue to load it from,
+ * live only at the entry.
+ */
+void share_stack_slots() {
+    if (!build_intervals()) return;
+
+    int n = ra_vars + ra_temps;
+    int *from  = (int *)arena_alloc(&func_arena, (n + 1) * sizeof(int));
+    int *order = (int *)arena_alloc(&func_arena, (n + 1) * sizeof(int));
+    int  count = 0;
+    for (int v = 0; v < n; v++) {
+        if (end[v] < 0) continue;
+
+        int reg = ra_valid ? reg_of[v] : -1;
+        if (v < ra_vars) {
+            symtab_entry *var = vars[v];
+            if (var->scope != LOCAL || var->is_param) continue;
+            if (reg >= 0 && !(live_in && BIT_TEST(live_in, v))) continue;
+        } else if (reg >= 0 || (ra_valid && remat[v - ra_vars])) {
+            continue;
+        }
+
+        from[v] = start[v];
+        order[count++] = v;
+    }
+    sort_start = from;
+    qsort(order, count, sizeof(int), by_start);
+
+    int *slot       = (int *)arena_alloc(&func_arena, (n + 1) * sizeof(int));
+    int *free_slots = (int *)arena_alloc(&func_arena, (count + 1) * sizeof(int));
+    int  num_free   = 0;
+    heap_val   = (int *)arena_alloc(&func_arena, (count + 1) * sizeof(int));
+    heap_count = 0;
+    num_slots  = 0;
+    for (int k = 0; k < count; k++) {
+        int v = order[k];
+        while (heap_count > 0 && end[heap_val[0]] < start[v]) free_slots[num_free++] = slot[heap_pop()];
+
+        slot[v] = num_free > 0 ? free_slots[--num_free] : num_slots++;
+        if (ra_valid && reg_of[v] >= 0) {
+            // in a register but for the load at the entry
+            free_slots[num_free++] = slot[v];
+        } else {
+            heap_push(v);
+        }
+    }
+
+    // the locals find theirs through the symbol table
+    slot_of = (int *)arena_alloc(&func_arena, (ra_temps + 1) * sizeof(int));
+    for (int k = 0; k < count; k++) {
+        int v = order[k];
+        if (v < ra_vars) {
+            vars[v]->fp_offset = -4 * (slot[v] + 1);
+        } else {
+            slot_of[v - ra_vars] = slot[v];
+        }
+    }
+
+    slots_valid = 1;
+}
+
+
+/*************** REGISTER STACK *****************/
+
+/*
+ * Without the allocator (at -O0), the temps still get the caller-saved
+ * registers, but as a stack, with no liveness and no spill choice: in
+ * the order the code runs, the temps read for the last time give their
+ * registers back and the temp set takes the lowest one free that no
+ * call made before its last read may change.  Temps come out of an
+ * expression in the order its operands are worked out (see su_need), so
+ * an expression only runs out of registers, and leaves temps in memory,
+ * if it needs more of them at once than there are.  A temp read past
+ * the end of its block is left in memory.
+ */
+void stack_registers() {
+    if (ra_valid) return;
+    number_vars();
+
+    int n = num_vars + tmp_num;
+    ra_vars   = num_vars;
+    ra_temps  = tmp_num;
+    reg_of    = (int *)arena_alloc(&func_arena, (n + 1) * sizeof(int));
+    remat     = (char *)arena_alloc(&func_arena, tmp_num + 1);
+    remat_val = (int *)arena_alloc(&func_arena, (tmp_num + 1) * sizeof(int));
+    for (int v = 0; v < n; v++) reg_of[v] = -1;
+
+    // where each temp is set and last read, and how many blocks have
+    // ended before each instr
+    int *def    = (int *)arena_alloc(&func_arena, (tmp_num + 1) * sizeof(int));
+    int *last   = (int *)arena_alloc(&func_arena, (tmp_num + 1) * sizeof(int));
+    int *blocks = (int *)arena_alloc(&func_arena, (ir.count + 1) * sizeof(int));
+    for (int t = 0; t < tmp_num; t++) def[t] = last[t] = -1;
+
+    calls = (int *)arena_alloc(&func_arena, (ir.count + 1) * sizeof(int));
+    num_calls = 0;
+    for (int i = 0; i < ir.count; i++) {
+        Instr *instr = &ir.instr[i];
+        blocks[i + 1] = blocks[i] + (instr->op == OP_LABEL || ends_block(instr->op));
+        if (instr->op == OP_CALL) {
+            calls[num_calls++] = i;
+            continue;
+        }
+
+        if (OPND_TYPE(instr->src1) == TEMP) last[OPND_INT(instr->src1)] = i;
+        if (OPND_TYPE(instr->src2) == TEMP) last[OPND_INT(instr->src2)] = i;
+        if (OPND_TYPE(instr->dest) == TEMP) {
+            int t = OPND_INT(instr->dest);
+            def[t] = def[t] < 0 ? i : ir.count;
+        }
+    } build_clob_rows();
+
+    RegSet busy = 0;
+    for (int i = 0; i < ir.count; i++) {
+        Instr *instr = &ir.instr[i];
+        if (instr->op == OP_CALL) continue;
+
+        Operand srcs[2] = { instr->src1, instr->src2 };
+        for (int k = 0; k < 2; k++) {
+            if (OPND_TYPE(srcs[k]) != TEMP) continue;
+            int t = OPND_INT(srcs[k]);
+            if (last[t] == i && reg_of[ra_vars + t] >= 0) busy &= ~REG_BIT(reg_of[ra_vars + t]);
+        }
+
+        if (OPND_TYPE(instr->dest) != TEMP) continue;
+        int t = OPND_INT(instr->dest);
+        if (def[t] != i || last[t] <= i || blocks[last[t]] != blocks[i + 1]) continue;
+
+        int r = free_reg(caller_saved, NUM_TREGS, NULL, busy | calls_clobber(2 * i + 1, 2 * last[t]));
+        if (r < 0) continue;
+        reg_of[ra_vars + t] = r;
+        busy |= REG_BIT(r);
+    }
+
+    ra_valid = 1;
+}
@@ -0,0 +1,51 @@
+/*
+ * File: regalloc.h
+ * Author: Maria Fay Garcia
+ * Purpose: To outline the register allocator, which gives the temps,
+ *          locals and params of a function registers over their live
+ *          intervals before it is translated to mips, and shares the
+ *          stack slots of what is left in memory
+ */
+#ifndef __REGALLOC_H__
+#define __REGALLOC_H__
+
+#include "code_gen.h"
+
+// registers are named by their mips numbers; $t0 and $t1 are never
+// given out, translation loads what is left in memory into them
+#define REG_T0     8
+#define REG_T1     9
+#define REG_S0    16
+#define NUM_SREGS  8
+
+// a set of registers, a bit each
+typedef unsigned int RegSet;
+
+#define REG_BIT(r) ((RegSet)1 << (r))
+
+extern char *reg_name[32];
+
+// the callee-saved registers the function uses, which its prologue
+// saves and its epilogue restores, in slots below its temps
+extern int   saved_regs[NUM_SREGS];
+extern int   num_saved_regs;
+
+// the variables given a register that may be read before they are set,
+// which the prologue loads from their homes
+extern symtab_entry **entry_loads;
+extern int        num_entry_loads;
+
+// function stubs
+void     alloc_registers  (                       );
+void     stack_registers  (                       );
+void     share_stack_slots(                       );
+void     clear_registers  (                       );
+int      operand_reg      (Operand              op);
+int      remat_const      (Operand              op,
+                           int                *val);
+int      temp_slot        (int                temp);
+int      frame_slots      (                       );
+RegSet   call_clobbers    (Instr            *call);
+void     record_clobbers  (                       );
+
+#endif  /* __REGALLOC_H__ */
@@ -0,0 +1,264 @@
+/*
+ * File: scan_gen.c
+ * Author: Maria Fay Garcia
+ * Purpose: Generate the scanner's FSA and keyword hash as static const
+ *          C tables.  Run at build time: ./scan_gen > scan_table.h
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "scanner.h"
+
+// 40 states
+// states 1-27 are the accept states, numbered after the Token they accept
+#define NUM_STATES 40
+#define NUM_CHARS  256
+
+// the non-accepting states
+#define START     0
+#define IDENT    28
+#define DIGITS   29
+#define ASSG_EQ  30
+#define NOT_NE   31
+#define GT_GE    32
+#define LT_LE    33
+#define AMP      34
+#define BAR      35
+#define SLASH    36
+#define COMMENT  37
+#define STAR     38
+#define SPACE    39
+
+// the table being built
+static unsigned char next_state[NUM_STATES][NUM_CHARS];
+static unsigned char retract   [NUM_STATES][NUM_CHARS];
+
+
+/*************** SPECIFICATION HELPERS *****************/
+
+// state -- c --> next
+static void on(int state, int c, int next) {
+    next_state[state][c] = next;
+    retract[state][c] = 0;
+}
+
+// state -- any char in [lo, hi] --> next
+static void on_range(int state, int lo, int hi, int next) {
+    for (int c = lo; c <= hi; c++) on(state, c, next);
+}
+
+// state -- anything else --> next; the char is pushed back if push_back
+static void otherwise(int state, int next, int push_back) {
+    for (int c = 0; c < NUM_CHARS; c++) {
+        next_state[state][c] = next;
+        retract[state][c] = push_back;
+    }
+}
+
+static void on_letters(int state, int next) {
+    on_range(state, 'A', 'Z', next);
+    on_range(state, 'a', 'z', next);
+}
+
+static void on_digits(int state, int next) { on_range(state, '0', '9', next); }
+
+static void on_space(int state, int next) {
+    on(state, '\t', next);
+    on(state, '\n', next);
+    on(state,  ' ', next);
+}
+
+
+/*************** THE FSA *****************/
+
+// a transition to START that is not an accept just throws the
+// characters read so far away (whitespace, comments, bad characters)
+static void build_fsa() {
+    // state 0 -- the start state
+    otherwise(START, START, 0);
+    on_space  (START,   SPACE);
+    on        (START, '!', NOT_NE);
+    on        (START, '&',    AMP);
+    on        (START, '(', LPAREN);
+    on        (START, ')', RPAREN);
+    on        (START, '*',  opMUL);
+    on        (START, '+',  opADD);
+    on        (START, ',',  COMMA);
+    on        (START, '-',  opSUB);
+    on        (START, '/',  SLASH);
+    on_digits (START,      DIGITS);
+    on        (START, ';',   SEMI);
+    on        (START, '<',  LT_LE);
+    on        (START, '=', ASSG_EQ);
+    on        (START, '>',  GT_GE);
+    on_letters(START,       IDENT);
+    on        (START, '{', LBRACE);
+    on        (START, '|',    BAR);
+    on        (START, '}', RBRACE);
+
+    // {letter | digit | _}; keywords are sorted out after the accept
+    otherwise (IDENT, ID, 1);
+    on_letters(IDENT, IDENT);
+    on_digits (IDENT, IDENT);
+    on        (IDENT, '_', IDENT);
+
+    // digits
+    otherwise(DIGITS, INTCON, 1);
+    on_digits(DIGITS, DIGITS);
+
+    // = and ==
+    otherwise(ASSG_EQ, opASSG, 1);
+    on       (ASSG_EQ, '=', opEQ);
+
+    // ! and !=
+    otherwise(NOT_NE, opNOT, 1);
+    on       (NOT_NE, '=', opNE);
+
+    // > and >=
+    otherwise(GT_GE, opGT, 1);
+    on       (GT_GE, '=', opGE);
+
+    // < and <=
+    otherwise(LT_LE, opLT, 1);
+    on       (LT_LE, '=', opLE);
+
+    // && (a lone & is dropped)
+    otherwise(AMP, START, 1);
+    on       (AMP, '&', opAND);
+
+    // || (a lone | is dropped)
+    otherwise(BAR, START, 1);
+    on       (BAR, '|', opOR);
+
+    // / and the start of /*
+    otherwise(SLASH, opDIV, 1);
+    on       (SLASH, '*', COMMENT);
+
+    // the middle of a comment
+    otherwise(COMMENT, COMMENT, 0);
+    on       (COMMENT, '*', STAR);
+
+    // finishing a comment
+    otherwise(STAR, COMMENT, 0);
+    on       (STAR, '*', STAR);
+    on       (STAR, '/', START);
+
+    // whitespace
+    otherwise(SPACE, START, 1);
+    on_space (SPACE, SPACE);
+}
+
+
+/*************** KEYWORDS *****************/
+
+typedef struct {
+    char *text;
+    int   tok;
+} Keyword;
+
+static Keyword keywords[] = {
+    {   "int",    kwINT },
+    {    "if",     kwIF },
+    {  "else",   kwELSE },
+    { "while",  kwWHILE },
+    {"return", kwRETURN },
+};
+
+#define NUM_KEYWORDS ((int)(sizeof(keywords) / sizeof(keywords[0])))
+
+// the hash is (len * mult + first char) & (size - 1)
+static int kw_size;
+static int kw_mult;
+static int kw_slot[64];
+
+static int kw_hash(char *text, int mult, int size) {
+    return ((int)strlen(text) * mult + text[0]) & (size - 1);
+}
+
+// find the smallest table and multiplier that give no collisions
+static void find_perfect_hash() {
+    for (kw_size = 8; kw_size <= 64; kw_size *= 2) {
+        for (kw_mult = 1; kw_mult < 256; kw_mult++) {
+            int used[64] = {0}, ok = 1;
+            for (int i = 0; i < NUM_KEYWORDS && ok; i++) {
+                int h = kw_hash(keywords[i].text, kw_mult, kw_size);
+                if (used[h]) ok = 0;
+                used[h] = 1;
+            }
+            if (ok) return;
+        }
+    }
+
+    fprintf(stderr, "scan_gen: no perfect hash for the keywords\n");
+    exit(1);
+}
+
+
+/*************** OUTPUT *****************/
+
+// print one row of a bitmap: bit c of word c/32 is set if row[c]
+static void print_bitmap(unsigned char *row, int n) {
+    printf("{ ");
+    for (int w = 0; w < n / 32; w++) {
+        unsigned int bits = 0;
+        for (int b = 0; b < 32; b++) {
+            if (row[w*32 + b]) bits |= 1u << b;
+        } printf("0x%08x%s", bits, w + 1 < n / 32 ? ", " : " ");
+    } printf("}");
+}
+
+int main() {
+    build_fsa();
+    find_perfect_hash();
+
+    printf("/* generated by scan_gen -- do not edit */\n\n");
+    // the states the scanner has fast paths for
+    printf("#define SCAN_IDENT_STATE   %d\n", IDENT);
+    printf("#define SCAN_DIGITS_STATE  %d\n", DIGITS);
+    printf("#define SCAN_COMMENT_STATE %d\n", COMMENT);
+    printf("#define SCAN_SPACE_STATE   %d\n\n", SPACE);
+
+    // next state for every (state, char)
+    printf("static const unsigned char scan_next[%d][%d] = {\n", NUM_STATES, NUM_CHARS);
+    for (int s = 0; s < NUM_STATES; s++) {
+        printf("  {");
+        for (int c = 0; c < NUM_CHARS; c++) {
+            if (c % 32 == 0) printf("\n   ");
+            printf(" %2d,", next_state[s][c]);
+        } printf("\n  },\n");
+    } printf("};\n\n");
+
+    // whether the char that caused a transition goes back into the input
+    printf("static const unsigned int scan_retract[%d][%d] = {\n", NUM_STATES, NUM_CHARS / 32);
+    for (int s = 0; s < NUM_STATES; s++) {
+        printf("  ");
+        print_bitmap(retract[s], NUM_CHARS);
+        printf(",\n");
+    } printf("};\n\n");
+
+    // the accept states
+    unsigned char accept[64] = {0};
+    for (int s = UNDEF + 1; s <= opNOT; s++) accept[s] = 1;
+    printf("static const unsigned int scan_accept[2] = ");
+    print_bitmap(accept, 64);
+    printf(";\n\n");
+
+    // the keywords, at the slot their perfect hash picks
+    for (int h = 0; h < kw_size; h++) kw_slot[h] = -1;
+    for (int i = 0; i < NUM_KEYWORDS; i++) {
+        kw_slot[kw_hash(keywords[i].text, kw_mult, kw_size)] = i;
+    }
+
+    printf("#define KW_HASH(len, first) (((len) * %d + (first)) & %d)\n\n", kw_mult, kw_size - 1);
+    printf("static const struct { char *text; int len; int tok; } kw_table[%d] = {\n", kw_size);
+    for (int h = 0; h < kw_size; h++) {
+        if (kw_slot[h] < 0) {
+            printf("  { \"\", 0, ID },\n");
+        } else {
+            Keyword *kw = &keywords[kw_slot[h]];
+            printf("  { \"%s\", %d, %d },\n", kw->text, (int)strlen(kw->text), kw->tok);
+        }
+    } printf("};\n");
+
+    return 0;
+}
@@ -0,0 +1,240 @@
+/*
+ * File: scan_simd.c
+ * Author: Maria Fay Garcia
+ * Purpose: Scalar and SSE2 kernels for skipping whitespace, comment
+ *          bodies and identifier/digit runs.  The best version the CPU
+ *          supports is picked the first time a kernel is used
+ */
+#include "scan_simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HAVE_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+
+/*************** SCALAR KERNELS *****************/
+
+static int is_space(unsigned char c) { return c == ' ' || c == '\t' || c == '\n'; }
+static int is_digit(unsigned char c) { return (unsigned char)(c - '0') < 10; }
+static int is_ident(unsigned char c) {
+    return (unsigned char)((c | 0x20) - 'a') < 26 || is_digit(c) || c == '_';
+}
+
+// count the newlines in p[0 .. n), remembering where the last one was
+static void scalar_newlines(const char *p, int n, int *newlines, int *last_nl) {
+    for (int i = 0; i < n; i++) {
+        if (p[i] == '\n') {
+            (*newlines)++;
+            *last_nl = i;
+        }
+    }
+}
+
+static int scalar_space_run(const char *p, int n, int *newlines, int *last_nl) {
+    int i = 0;
+    *newlines = 0;
+    *last_nl = -1;
+    while (i < n && is_space(p[i])) i++;
+    scalar_newlines(p, i, newlines, last_nl);
+    return i;
+}
+
+static int scalar_ident_run(const char *p, int n) {
+    int i = 0;
+    while (i < n && is_ident(p[i])) i++;
+    return i;
+}
+
+static int scalar_digit_run(const char *p, int n) {
+    int i = 0;
+    while (i < n && is_digit(p[i])) i++;
+    return i;
+}
+
+// everything up to the '*' of the first "*/"
+static int scalar_comment_run(const char *p, int n, int *newlines, int *last_nl) {
+    int i = 0;
+    *newlines = 0;
+    *last_nl = -1;
+    while (i < n && !(p[i] == '*' && i + 1 < n && p[i+1] == '/')) i++;
+    scalar_newlines(p, i, newlines, last_nl);
+    return i;
+}
+
+
+#ifdef HAVE_X86_KERNELS
+
+// identifiers and numbers are usually only a few chars long
+#define SHORT_RUN 8
+
+/*************** SSE2 KERNELS *****************/
+
+// bytes of v in [lo, hi], using one signed compare
+#define SSE_IN_RANGE(v, lo, hi) \
+    _mm_cmplt_epi8(_mm_add_epi8((v), _mm_set1_epi8((char)(-128 - (lo)))), \
+                   _mm_set1_epi8((char)(-128 + (hi) - (lo) + 1)))
+
+static inline __m128i sse_space(__m128i v) {
+    return _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                                     _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+                        _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+}
+
+static inline __m128i sse_ident(__m128i v) {
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    return _mm_or_si128(_mm_or_si128(SSE_IN_RANGE(lower, 'a', 'z'),
+                                     SSE_IN_RANGE(v, '0', '9')),
+                        _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+}
+
+// add the newlines among the first len bytes of a 16 byte block at base
+static inline void sse_count_nl(__m128i v, int len, int base, int *newlines, int *last_nl) {
+    unsigned int nl = _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+    nl &= len >= 16 ? 0xffffu : (1u << len) - 1;
+    if (nl) {
+        *newlines += __builtin_popcount(nl);
+        *last_nl = base + 31 - __builtin_clz(nl);
+    }
+}
+
+static int sse2_space_run(const char *p, int n, int *newlines, int *last_nl) {
+    int i = 0;
+    *newlines = 0;
+    *last_nl = -1;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+        unsigned int stop = ~_mm_movemask_epi8(sse_space(v)) & 0xffff;
+        int len = stop ? __builtin_ctz(stop) : 16;
+        sse_count_nl(v, len, i, newlines, last_nl);
+        if (stop) return i + len;
+    }
+
+    int nl = 0, last = -1;
+    int len = scalar_space_run(p + i, n - i, &nl, &last);
+    if (nl) {
+        *newlines += nl;
+        *last_nl = i + last;
+    } return i + len;
+}
+
+static int sse2_ident_run(const char *p, int n) {
+    // most runs are short, so look at the first few bytes one at a time
+    int i = 0;
+    while (i < SHORT_RUN) {
+        if (i == n || !is_ident(p[i])) return i;
+        i++;
+    }
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+        unsigned int stop = ~_mm_movemask_epi8(sse_ident(v)) & 0xffff;
+        if (stop) return i + __builtin_ctz(stop);
+    } return i + scalar_ident_run(p + i, n - i);
+}
+
+static int sse2_digit_run(const char *p, int n) {
+    // most runs are short, so look at the first few bytes one at a time
+    int i = 0;
+    while (i < SHORT_RUN) {
+        if (i == n || !is_digit(p[i])) return i;
+        i++;
+    }
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+        unsigned int stop = ~_mm_movemask_epi8(SSE_IN_RANGE(v, '0', '9')) & 0xffff;
+        if (stop) return i + __builtin_ctz(stop);
+    } return i + scalar_digit_run(p + i, n - i);
+}
+
+static int sse2_comment_run(const char *p, int n, int *newlines, int *last_nl) {
+    int i = 0;
+    *newlines = 0;
+    *last_nl = -1;
+
+    // compare each byte with '*' and its successor with '/'
+    for (; i + 17 <= n; i += 16) {
+        __m128i v    = _mm_loadu_si128((const __m128i *)(p + i));
+        __m128i next = _mm_loadu_si128((const __m128i *)(p + i + 1));
+        unsigned int stop = _mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('*')),
+                              _mm_cmpeq_epi8(next, _mm_set1_epi8('/'))));
+        int len = stop ? __builtin_ctz(stop) : 16;
+        sse_count_nl(v, len, i, newlines, last_nl);
+        if (stop) return i + len;
+    }
+
+    int nl = 0, last = -1;
+    int len = scalar_comment_run(p + i, n - i, &nl, &last);
+    if (nl) {
+        *newlines += nl;
+        *last_nl = i + last;
+    } return i + len;
+}
+
+
+#endif  /* HAVE_X86_KERNELS */
+
+
+/*************** DISPATCH *****************/
+
+// the kernels start out as stubs that pick the real ones on first use
+static int resolve_space_run(const char *p, int n, int *newlines, int *last_nl) {
+    use_kernels(best_kernel_level());
+    return scan_kernels.space_run(p, n, newlines, last_nl);
+}
+
+static int resolve_ident_run(const char *p, int n) {
+    use_kernels(best_kernel_level());
+    return scan_kernels.ident_run(p, n);
+}
+
+static int resolve_digit_run(const char *p, int n) {
+    use_kernels(best_kernel_level());
+    return scan_kernels.digit_run(p, n);
+}
+
+static int resolve_comment_run(const char *p, int n, int *newlines, int *last_nl) {
+    use_kernels(best_kernel_level());
+    return scan_kernels.comment_run(p, n, newlines, last_nl);
+}
+
+ScanKernels scan_kernels = {
+    resolve_space_run,
+    resolve_ident_run,
+    resolve_digit_run,
+    resolve_comment_run
+};
+
+// the fastest kernels this CPU can run
+KernelLevel best_kernel_level() {
+#ifdef HAVE_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) return KERNELS_SSE2;
+#endif
+    return KERNELS_SCALAR;
+}
+
+// switch the scanner to a given set of kernels
+// returns 0 if this build or CPU cannot run them
+int use_kernels(KernelLevel level) {
+    if (level > best_kernel_level()) return 0;
+
+    switch (level) {
+#ifdef HAVE_X86_KERNELS
+        case KERNELS_SSE2:
+            scan_kernels.space_run   = sse2_space_run;
+            scan_kernels.ident_run   = sse2_ident_run;
+            scan_kernels.digit_run   = sse2_digit_run;
+            scan_kernels.comment_run = sse2_comment_run;
+            return 1;
+#endif
+        default:
+            scan_kernels.space_run   = scalar_space_run;
+            scan_kernels.ident_run   = scalar_ident_run;
+            scan_kernels.digit_run   = scalar_digit_run;
+            scan_kernels.comment_run = scalar_comment_run;
+            return 1;
+    }
+}
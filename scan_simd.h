@@ -0,0 +1,34 @@
+/*
+ * File: scan_simd.h
+ * Author: Maria Fay Garcia
+ * Purpose: Kernels the scanner uses to skip over runs of characters
+ *          that all take the same FSA transition
+ */
+#ifndef __SCAN_SIMD_H__
+#define __SCAN_SIMD_H__
+
+// which implementation the kernels use
+typedef enum {
+    KERNELS_SCALAR,
+    KERNELS_SSE2
+} KernelLevel;
+
+/*
+ * Each kernel looks at p[0 .. n) and returns how many bytes at the front
+ * of it belong to the run.  The newline counts are for the bytes of the
+ * run only; last_nl is the index of the last newline in the run (or -1).
+ */
+typedef struct {
+    int (*space_run)  (const char *p, int n, int *newlines, int *last_nl);
+    int (*ident_run)  (const char *p, int n);
+    int (*digit_run)  (const char *p, int n);
+    int (*comment_run)(const char *p, int n, int *newlines, int *last_nl);
+} ScanKernels;
+
+extern ScanKernels scan_kernels;
+
+// function stubs
+KernelLevel best_kernel_level(                 );
+int         use_kernels      (KernelLevel level);
+
+#endif  /* __SCAN_SIMD_H__ */
@@ -43,26 +43,25 @@ char* token_name[] = {
 };
 
 extern int get_token();
-extern char* lexeme;
+extern int tok_off;
+extern int tok_len;
 
-extern void setup_table();
-
-void print_token(Token tok, char* lexeme) {
+void print_token(Token tok, char* lexeme, int len) {
   if (tok < UNDEF || tok > opNOT) {
     printf("TOKEN VALUE OUT OF BOUNDS: %d\n", tok);
   }
   else {
-    printf("%s : %s\n", token_name[tok], lexeme);
+    printf("%s : %.*s\n", token_name[tok], len, lexeme);
   }
 }
 
 int main() {
   int tok;
 
-  setup_table();
+  load_source(0);
 
   while ((tok = get_token()) != EOF) {
-    print_token(tok, lexeme);
+    print_token(tok, src_buf + tok_off, tok_len);
   }
 
   return 0;
@@ -10,6 +10,8 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include "source.h"
+#include "intern.h"
 
 /*
  * The enum Token defines integer values for the various tokens.  These
@@ -46,55 +48,32 @@ typedef enum {
   opNOT     /* ! : Op: logical-not */
 } Token;
 
+/*
+ * The whole program as parallel arrays, one entry per token, filled in
+ * by scan_all().  The last entry is EOF.
+ */
+typedef struct {
+  signed char  *kind;    /* the Token */
+  int          *start;   /* offset of the lexeme in src_buf */
+  int          *len;     /* length of the lexeme */
+  int          *value;   /* value of an INTCON */
+  char        **atom;    /* interned name of an ID */
+  int           count;
+  int           cap;
+} TokenArray;
+
+extern TokenArray toks;
+
 /* function prototypes */
 extern int get_token(void);
 
 // function stubs
-int get_token     (             );
-int keywd_or_id   (             );
-int is_final_state(int cur_state);
-
-// transition functions
-int  undef();
-int     t1();
-int     t2();
-int     t3();
-int     t4();
-int     t5();
-int     t6();
-int lparen();
-int rparen();
-int lbrace();
-int rbrace();
-int  comma();
-int   semi();
-int     t7();
-int     t8();
-int     t9();
-int    add();
-int    sub();
-int    mul();
-int    t10();
-int divide();
-int    t11();
-int    t12();
-int    t13();
-int    t14();
-int    t15();
-int    t16();
-int    t17();
-int    t18();
-int    t19();
-int    t20();
-int    t21();
-int    t22();
-int    t23();
-int    t24();
-int    t25();
-int    t26();
-int    t27();
-int    t28();
-int    t29();
-int    t30();
+int  get_token     (                        );
+int  keywd_or_id   (                        );
+int  lexeme_value  (                        );
+void scan_all      (                        );
+void tok_position  (int  i                   ,
+                    int *line                ,
+                    int *col                );
 
 #endif  /* __SCANNER_H__ */
@@ -0,0 +1,344 @@
+/*
+ * File: sel_gen.c
+ * Author: Maria Fay Garcia
+ * Purpose: Generate the instruction selector's matcher from its table of
+ *          mips patterns and their costs.  Run at build time:
+ *          ./sel_gen > sel_table.h
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+/*
+ * A rule rewrites a tree matching its pattern to its nonterminal at its
+ * cost, by the code of its template.  A pattern is a nonterminal (a chain
+ * rule), a terminal, or a terminal over one or two patterns.  The leaves
+ * of a pattern -- its nonterminals and the terminals without kids -- are
+ * numbered from 0, left to right.  In a template:
+ *     %d       the register the result goes in
+ *     %0 %1    the value of a leaf: a register, constant or location
+ *     %n1      the negated constant of a leaf
+ *     %k1 %j1  log2 of a leaf's constant, and 32 less that
+ *     %c %m %r the constant, location or register of a terminal
+ *     %L       the label a branch goes to
+ * and instrs are split by ';'.  A template "=x" makes no code, the value
+ * is x.  CMP stands for each comparison: %o is its name, %S the name of
+ * the one that holds with the operands swapped.
+ */
+typedef struct {
+    char *lhs;
+    char *pattern;
+    int   cost;
+    char *tmpl;
+} Rule;
+
+static Rule rules[] = {
+    // the leaves
+    { "reg",  "REG",                  0, "=%r" },
+    { "mem",  "MEM",                  0, "=%m" },
+    { "reg",  "mem",                  1, "lw %d, %0" },
+    { "reg",  "ZERO",                 0, "=$zero" },
+    { "imm",  "ZERO",                 0, "=%c" },
+    { "imm",  "POW2",                 0, "=%c" },
+    { "imm",  "IMM16",                0, "=%c" },
+    { "con",  "imm",                  0, "=%0" },
+    { "con",  "CON",                  0, "=%c" },
+    { "reg",  "imm",                  1, "li %d, %0" },
+    { "reg",  "CON",                  2, "li %d, %c" },
+
+    // copies
+    { "reg",  "ASSG(reg)",            0, "=%0" },
+    { "reg",  "ASSG(imm)",            1, "li %d, %0" },
+    { "reg",  "ASSG(CON)",            2, "li %d, %0" },
+    { "reg",  "ASSG(mem)",            1, "lw %d, %0" },
+
+    // arithmetic; add, addi, sub and neg trap on overflow
+    { "reg",  "PLUS(reg, imm)",       1, "addi %d, %0, %1" },
+    { "reg",  "PLUS(imm, reg)",       1, "addi %d, %1, %0" },
+    { "reg",  "PLUS(reg, reg)",       1, "add %d, %0, %1" },
+    { "reg",  "MINUS(reg, imm)",      1, "addi %d, %0, %n1" },
+    { "reg",  "MINUS(reg, reg)",      1, "sub %d, %0, %1" },
+    { "reg",  "MUL(reg, POW2)",       1, "sll %d, %0, %k1" },
+    { "reg",  "MUL(POW2, reg)",       1, "sll %d, %1, %k0" },
+    { "reg",  "MUL(reg, reg)",        1, "mul %d, %0, %1" },
+    { "reg",  "DIV(reg, POW2)",       4, "sra $t1, %0, 31; srl $t1, $t1, %j1; addu $t1, %0, $t1; sra %d, $t1, %k1" },
+    { "reg",  "DIV(reg, reg)",        4, "div %d, %0, %1" },
+    { "reg",  "NEG(reg)",             1, "neg %d, %0" },
+
+    // compare and branch
+    { "stmt", "CMP(reg, ZERO)",       1, "b%oz %0, %L" },
+    { "stmt", "CMP(ZERO, reg)",       1, "b%Sz %1, %L" },
+    { "stmt", "CMP(reg, con)",        2, "b%o %0, %1, %L" },
+    { "stmt", "CMP(con, reg)",        2, "b%S %1, %0, %L" },
+    { "stmt", "CMP(reg, reg)",        1, "b%o %0, %1, %L" },
+};
+
+#define NUM_RULES ((int)(sizeof(rules) / sizeof(rules[0])))
+
+// the terminals: the operators of the three address code, then the
+// kinds of operand a leaf may be
+static char *terms[] = {
+    "PLUS", "MINUS", "MUL", "DIV", "NEG", "ASSG",
+    "EQ", "NE", "LT", "LE", "GT", "GE",
+    "REG", "MEM", "ZERO", "POW2", "IMM16", "CON",
+};
+
+#define NUM_TERMS ((int)(sizeof(terms) / sizeof(terms[0])))
+
+// the comparisons CMP stands for, their names in branches, and the
+// ones that hold with the operands swapped
+static char *cmps[]      = { "EQ", "NE", "LT", "LE", "GT", "GE" };
+static char *cmp_names[] = { "eq", "ne", "lt", "le", "gt", "ge" };
+static int   cmp_swap[]  = {   0,    1,    4,    5,    2,    3  };
+
+#define NUM_CMPS 6
+
+
+/*************** PATTERNS *****************/
+
+typedef struct Pat {
+    char        name[16];   // a terminal or nonterminal
+    int         term;       // its number among the terminals, -1 for a nonterminal
+    struct Pat *kid[2];
+} Pat;
+
+static char *nts[32];
+static int   num_nts = 0;
+
+static void fail(char *msg, char *what) {
+    fprintf(stderr, "sel_gen: %s: %s\n", msg, what);
+    exit(1);
+}
+
+static int term_num(char *name) {
+    for (int t = 0; t < NUM_TERMS; t++) {
+        if (strcmp(terms[t], name) == 0) return t;
+    } return -1;
+}
+
+// the number of a nonterminal, from 1
+static int nt_num(char *name) {
+    for (int k = 0; k < num_nts; k++) {
+        if (strcmp(nts[k], name) == 0) return k + 1;
+    } fail("unknown nonterminal", name);
+    return 0;
+}
+
+static void add_nt(char *name) {
+    for (int k = 0; k < num_nts; k++) {
+        if (strcmp(nts[k], name) == 0) return;
+    } nts[num_nts++] = name;
+}
+
+static Pat *parse_pat(char **s, char *cmp) {
+    Pat *pat = (Pat *)calloc(1, sizeof(Pat));
+    while (isspace(**s)) (*s)++;
+
+    int len = 0;
+    while (isalnum(**s) || **s == '_') {
+        if (len < 15) pat->name[len++] = **s;
+        (*s)++;
+    }
+    if (len == 0) fail("bad pattern at", *s);
+    if (strcmp(pat->name, "CMP") == 0) strcpy(pat->name, cmp);
+    pat->term = term_num(pat->name);
+
+    if (**s == '(') {
+        if (pat->term < 0) fail("a nonterminal with operands", pat->name);
+        (*s)++;
+        for (int k = 0; k < 2; k++) {
+            pat->kid[k] = parse_pat(s, cmp);
+            while (isspace(**s)) (*s)++;
+            if (**s == ',') {
+                (*s)++;
+            } else {
+                break;
+            }
+        }
+        if (**s != ')') fail("missing ) at", *s);
+        (*s)++;
+    } return pat;
+}
+
+
+/*************** THE RULES, EXPANDED *****************/
+
+typedef struct {
+    int    lhs;
+    Pat   *pat;
+    int    cost;
+    char  *tmpl;
+    int    chain;       // the nonterminal of a chain rule, else 0
+    int    num_leaves;
+    char   leaf_path[3][4];
+    int    leaf_nt[3];
+} Expanded;
+
+static Expanded exp_rules[NUM_RULES * NUM_CMPS];
+static int      num_exp = 0;
+
+// a template with %o and %S put in for comparison c
+static char *fill_cmp(char *tmpl, int c) {
+    char *out = (char *)malloc(strlen(tmpl) + 16);
+    char *o = out;
+    for (char *s = tmpl; *s; s++) {
+        if (s[0] == '%' && (s[1] == 'o' || s[1] == 'S')) {
+            o += sprintf(o, "%s", cmp_names[s[1] == 'o' ? c : cmp_swap[c]]);
+            s++;
+        } else {
+            *o++ = *s;
+        }
+    } *o = 0;
+    return out;
+}
+
+// the leaves of pat, by the kids taken to reach them
+static void find_leaves(Expanded *e, Pat *pat, char *path) {
+    if (pat->kid[0]) {
+        for (int k = 0; k < 2 && pat->kid[k]; k++) {
+            char sub[4];
+            snprintf(sub, sizeof(sub), "%s%d", path, k);
+            find_leaves(e, pat->kid[k], sub);
+        } return;
+    }
+
+    if (e->num_leaves == 3) fail("too many leaves in", e->pat->name);
+    strcpy(e->leaf_path[e->num_leaves], path);
+    e->leaf_nt[e->num_leaves] = pat->term < 0 ? nt_num(pat->name) : 0;
+    e->num_leaves++;
+}
+
+static void expand_rules() {
+    for (int r = 0; r < NUM_RULES; r++) add_nt(rules[r].lhs);
+
+    for (int r = 0; r < NUM_RULES; r++) {
+        int is_cmp = strstr(rules[r].pattern, "CMP") != NULL;
+        for (int c = 0; c < (is_cmp ? NUM_CMPS : 1); c++) {
+            Expanded *e = &exp_rules[num_exp++];
+            char *s = rules[r].pattern;
+            e->lhs  = nt_num(rules[r].lhs);
+            e->pat  = parse_pat(&s, cmps[c]);
+            e->cost = rules[r].cost;
+            e->tmpl = is_cmp ? fill_cmp(rules[r].tmpl, c) : rules[r].tmpl;
+            if (e->pat->term < 0) {
+                // a chain rule: its one leaf is the node itself
+                e->chain = nt_num(e->pat->name);
+                e->num_leaves = 1;
+                e->leaf_nt[0] = e->chain;
+            } else if (e->pat->kid[0]) {
+                find_leaves(e, e->pat, "");
+            }
+        }
+    }
+}
+
+
+/*************** OUTPUT *****************/
+
+// the C expression for the node at the end of path from n
+static char *node_at(char *path) {
+    static char buf[8][64];
+    static int  next = 0;
+    char *out = buf[next++ % 8];
+    strcpy(out, "n");
+    for (char *p = path; *p; p++) sprintf(out + strlen(out), "->kid[%c]", *p);
+    return out;
+}
+
+// the tests that the tree at path matches pat, and the cost of its leaves
+static void print_match(Pat *pat, char *path, char *test, char *cost) {
+    char *node = node_at(path);
+    if (pat->term < 0) {
+        sprintf(test + strlen(test), " && %s->cost[%d] < SEL_INF", node, nt_num(pat->name));
+        sprintf(cost + strlen(cost), " + %s->cost[%d]", node, nt_num(pat->name));
+        return;
+    }
+
+    if (path[0]) sprintf(test + strlen(test), " && %s->op == SEL_%s", node, pat->name);
+    for (int k = 0; k < 2 && pat->kid[k]; k++) {
+        char sub[4];
+        snprintf(sub, sizeof(sub), "%s%d", path, k);
+        print_match(pat->kid[k], sub, test, cost);
+    }
+}
+
+static void print_c_string(char *s) {
+    putchar('"');
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') putchar('\\');
+        putchar(*s);
+    } putchar('"');
+}
+
+int main() {
+    expand_rules();
+
+    printf("/* generated by sel_gen -- do not edit */\n\n");
+
+    // the terminals and nonterminals
+    for (int t = 0; t < NUM_TERMS; t++) printf("#define SEL_%-8s %d\n", terms[t], t);
+    printf("#define SEL_NUM_TERMS %d\n\n", NUM_TERMS);
+    for (int k = 0; k < num_nts; k++) printf("#define SEL_NT_%-6s %d\n", nts[k], k + 1);
+    printf("#define SEL_NUM_NTS %d\n\n", num_nts + 1);
+    printf("#if SEL_NUM_NTS > SEL_MAX_NTS\n#error \"too many nonterminals for SEL_MAX_NTS\"\n#endif\n\n");
+
+    // the rules, for the reducer
+    printf("static const SelRule sel_rules[%d] = {\n", num_exp);
+    for (int r = 0; r < num_exp; r++) {
+        Expanded *e = &exp_rules[r];
+        printf("  { %d, %d, %d, %d, { \"%s\", \"%s\", \"%s\" }, { %d, %d, %d }, ",
+               e->lhs, e->chain, e->cost, e->num_leaves,
+               e->leaf_path[0], e->leaf_path[1], e->leaf_path[2],
+               e->leaf_nt[0], e->leaf_nt[1], e->leaf_nt[2]);
+        print_c_string(e->tmpl);
+        printf(" },\n");
+    } printf("};\n\n");
+
+    // the chain rules, applied until none makes a nonterminal cheaper
+    printf("static void sel_closure(SelNode *n) {\n");
+    printf("    for (int changed = 1; changed; ) {\n");
+    printf("        changed = 0;\n");
+    for (int r = 0; r < num_exp; r++) {
+        Expanded *e = &exp_rules[r];
+        if (!e->chain) continue;
+        printf("        if (n->cost[%d] < SEL_INF && n->cost[%d] + %d < n->cost[%d]) {\n",
+               e->chain, e->chain, e->cost, e->lhs);
+        printf("            n->cost[%d] = n->cost[%d] + %d;\n", e->lhs, e->chain, e->cost);
+        printf("            n->rule[%d] = %d;\n", e->lhs, r);
+        printf("            changed = 1;\n");
+        printf("        }\n");
+    }
+    printf("    }\n}\n\n");
+
+    // the other rules, by the terminal at the root of their pattern
+    printf("// the cheapest way to rewrite n to each nonterminal, once its kids have theirs\n");
+    printf("static void sel_label(SelNode *n) {\n");
+    printf("    for (int nt = 0; nt < SEL_NUM_NTS; nt++) n->cost[nt] = SEL_INF;\n\n");
+    printf("    int c;\n");
+    printf("    switch (n->op) {\n");
+    for (int t = 0; t < NUM_TERMS; t++) {
+        int any = 0;
+        for (int r = 0; r < num_exp; r++) {
+            Expanded *e = &exp_rules[r];
+            if (e->chain || e->pat->term != t) continue;
+            if (!any) printf("        case SEL_%s:\n", terms[t]);
+            any = 1;
+
+            char test[512] = "1", cost[512] = "";
+            print_match(e->pat, "", test, cost);
+            printf("            if (%s) {\n", test);
+            printf("                c = %d%s;\n", e->cost, cost);
+            printf("                if (c < n->cost[%d]) {\n", e->lhs);
+            printf("                    n->cost[%d] = c;\n", e->lhs);
+            printf("                    n->rule[%d] = %d;\n", e->lhs, r);
+            printf("                }\n");
+            printf("            }\n");
+        } if (any) printf("            break;\n");
+    }
+    printf("    }\n\n");
+    printf("    sel_closure(n);\n");
+    printf("}\n");
+
+    return 0;
+}
@@ -0,0 +1,530 @@
+/* generated by sel_gen -- do not edit */
+
+#define SEL_PLUS     0
+#define SEL_MINUS    1
+#define SEL_MUL      2
+#define SEL_DIV      3
+#define SEL_NEG      4
+#define SEL_ASSG     5
+#define SEL_EQ       6
+#define SEL_NE       7
+#define SEL_LT       8
+#define SEL_LE       9
+#define SEL_GT       10
+#define SEL_GE       11
+#define SEL_REG      12
+#define SEL_MEM      13
+#define SEL_ZERO     14
+#define SEL_POW2     15
+#define SEL_IMM16    16
+#define SEL_CON      17
+#define SEL_NUM_TERMS 18
+
+#define SEL_NT_reg    1
+#define SEL_NT_mem    2
+#define SEL_NT_imm    3
+#define SEL_NT_con    4
+#define SEL_NT_stmt   5
+#define SEL_NUM_NTS 6
+
+#if SEL_NUM_NTS > SEL_MAX_NTS
+#error "too many nonterminals for SEL_MAX_NTS"
+#endif
+
+static const SelRule sel_rules[56] = {
+  { 1, 0, 0, 0, { "", "", "" }, { 0, 0, 0 }, "=%r" },
+  { 2, 0, 0, 0, { "", "", "" }, { 0, 0, 0 }, "=%m" },
+  { 1, 2, 1, 1, { "", "", "" }, { 2, 0, 0 }, "lw %d, %0" },
+  { 1, 0, 0, 0, { "", "", "" }, { 0, 0, 0 }, "=$zero" },
+  { 3, 0, 0, 0, { "", "", "" }, { 0, 0, 0 }, "=%c" },
+  { 3, 0, 0, 0, { "", "", "" }, { 0, 0, 0 }, "=%c" },
+  { 3, 0, 0, 0, { "", "", "" }, { 0, 0, 0 }, "=%c" },
+  { 4, 3, 0, 1, { "", "", "" }, { 3, 0, 0 }, "=%0" },
+  { 4, 0, 0, 0, { "", "", "" }, { 0, 0, 0 }, "=%c" },
+  { 1, 3, 1, 1, { "", "", "" }, { 3, 0, 0 }, "li %d, %0" },
+  { 1, 0, 2, 0, { "", "", "" }, { 0, 0, 0 }, "li %d, %c" },
+  { 1, 0, 0, 1, { "0", "", "" }, { 1, 0, 0 }, "=%0" },
+  { 1, 0, 1, 1, { "0", "", "" }, { 3, 0, 0 }, "li %d, %0" },
+  { 1, 0, 2, 1, { "0", "", "" }, { 0, 0, 0 }, "li %d, %0" },
+  { 1, 0, 1, 1, { "0", "", "" }, { 2, 0, 0 }, "lw %d, %0" },
+  { 1, 0, 1, 2, { "0", "1", "" }, { 1, 3, 0 }, "addi %d, %0, %1" },
+  { 1, 0, 1, 2, { "0", "1", "" }, { 3, 1, 0 }, "addi %d, %1, %0" },
+  { 1, 0, 1, 2, { "0", "1", "" }, { 1, 1, 0 }, "add %d, %0, %1" },
+  { 1, 0, 1, 2, { "0", "1", "" }, { 1, 3, 0 }, "addi %d, %0, %n1" },
+  { 1, 0, 1, 2, { "0", "1", "" }, { 1, 1, 0 }, "sub %d, %0, %1" },
+  { 1, 0, 1, 2, { "0", "1", "" }, { 1, 0, 0 }, "sll %d, %0, %k1" },
+  { 1, 0, 1, 2, { "0", "1", "" }, { 0, 1, 0 }, "sll %d, %1, %k0" },
+  { 1, 0, 1, 2, { "0", "1", "" }, { 1, 1, 0 }, "mul %d, %0, %1" },
+  { 1, 0, 4, 2, { "0", "1", "" }, { 1, 0, 0 }, "sra $t1, %0, 31; srl $t1, $t1, %j1; addu $t1, %0, $t1; sra %d, $t1, %k1" },
+  { 1, 0, 4, 2, { "0", "1", "" }, { 1, 1, 0 }, "div %d, %0, %1" },
+  { 1, 0, 1, 1, { "0", "", "" }, { 1, 0, 0 }, "neg %d, %0" },
+  { 5, 0, 1, 2, { "0", "1", "" }, { 1, 0, 0 }, "beqz %0, %L" },
+  { 5, 0, 1, 2, { "0", "1", "" }, { 1, 0, 0 }, "bnez %0, %L" },
+  { 5, 0, 1, 2, { "0", "1", "" }, { 1, 0, 0 }, "bltz %0, %L" },
+  { 5, 0, 1, 2, { "0", "1", "" }, { 1, 0, 0 }, "blez %0, %L" },
+  { 5, 0, 1, 2, { "0", "1", "" }, { 1, 0, 0 }, "bgtz %0, %L" },
+  { 5, 0, 1, 2, { "0", "1", "" }, { 1, 0, 0 }, "bgez %0, %L" },
+  { 5, 0, 1, 2, { "0", "1", "" }, { 0, 1, 0 }, "beqz %1, %L" },
+  { 5, 0, 1, 2, { "0", "1", "" }, { 0, 1, 0 }, "bnez %1, %L" },
+  { 5, 0, 1, 2, { "0", "1", "" }, { 0, 1, 0 }, "bgtz %1, %L" },
+  { 5, 0, 1, 2, { "0", "1", "" }, { 0, 1, 0 }, "bgez %1, %L" },
+  { 5, 0, 1, 2, { "0", "1", "" }, { 0, 1, 0 }, "bltz %1, %L" },
+  { 5, 0, 1, 2, { "0", "1", "" }, { 0, 1, 0 }, "blez %1, %L" },
+  { 5, 0, 2, 2, { "0", "1", "" }, { 1, 4, 0 }, "beq %0, %1, %L" },
+  { 5, 0, 2, 2, { "0", "1", "" }, { 1, 4, 0 }, "bne %0, %1, %L" },
+  { 5, 0, 2, 2, { "0", "1", "" }, { 1, 4, 0 }, "blt %0, %1, %L" },
+  { 5, 0, 2, 2, { "0", "1", "" }, { 1, 4, 0 }, "ble %0, %1, %L" },
+  { 5, 0, 2, 2, { "0", "1", "" }, { 1, 4, 0 }, "bgt %0, %1, %L" },
+  { 5, 0, 2, 2, { "0", "1", "" }, { 1, 4, 0 }, "bge %0, %1, %L" },
+  { 5, 0, 2, 2, { "0", "1", "" }, { 4, 1, 0 }, "beq %1, %0, %L" },
+  { 5, 0, 2, 2, { "0", "1", "" }, { 4, 1, 0 }, "bne %1, %0, %L" },
+  { 5, 0, 2, 2, { "0", "1", "" }, { 4, 1, 0 }, "bgt %1, %0, %L" },
+  { 5, 0, 2, 2, { "0", "1", "" }, { 4, 1, 0 }, "bge %1, %0, %L" },
+  { 5, 0, 2, 2, { "0", "1", "" }, { 4, 1, 0 }, "blt %1, %0, %L" },
+  { 5, 0, 2, 2, { "0", "1", "" }, { 4, 1, 0 }, "ble %1, %0, %L" },
+  { 5, 0, 1, 2, { "0", "1", "" }, { 1, 1, 0 }, "beq %0, %1, %L" },
+  { 5, 0, 1, 2, { "0", "1", "" }, { 1, 1, 0 }, "bne %0, %1, %L" },
+  { 5, 0, 1, 2, { "0", "1", "" }, { 1, 1, 0 }, "blt %0, %1, %L" },
+  { 5, 0, 1, 2, { "0", "1", "" }, { 1, 1, 0 }, "ble %0, %1, %L" },
+  { 5, 0, 1, 2, { "0", "1", "" }, { 1, 1, 0 }, "bgt %0, %1, %L" },
+  { 5, 0, 1, 2, { "0", "1", "" }, { 1, 1, 0 }, "bge %0, %1, %L" },
+};
+
+static void sel_closure(SelNode *n) {
+    for (int changed = 1; changed; ) {
+        changed = 0;
+        if (n->cost[2] < SEL_INF && n->cost[2] + 1 < n->cost[1]) {
+            n->cost[1] = n->cost[2] + 1;
+            n->rule[1] = 2;
+            changed = 1;
+        }
+        if (n->cost[3] < SEL_INF && n->cost[3] + 0 < n->cost[4]) {
+            n->cost[4] = n->cost[3] + 0;
+            n->rule[4] = 7;
+            changed = 1;
+        }
+        if (n->cost[3] < SEL_INF && n->cost[3] + 1 < n->cost[1]) {
+            n->cost[1] = n->cost[3] + 1;
+            n->rule[1] = 9;
+            changed = 1;
+        }
+    }
+}
+
+// the cheapest way to rewrite n to each nonterminal, once its kids have theirs
+static void sel_label(SelNode *n) {
+    for (int nt = 0; nt < SEL_NUM_NTS; nt++) n->cost[nt] = SEL_INF;
+
+    int c;
+    switch (n->op) {
+        case SEL_PLUS:
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->cost[3] < SEL_INF) {
+                c = 1 + n->kid[0]->cost[1] + n->kid[1]->cost[3];
+                if (c < n->cost[1]) {
+                    n->cost[1] = c;
+                    n->rule[1] = 15;
+                }
+            }
+            if (1 && n->kid[0]->cost[3] < SEL_INF && n->kid[1]->cost[1] < SEL_INF) {
+                c = 1 + n->kid[0]->cost[3] + n->kid[1]->cost[1];
+                if (c < n->cost[1]) {
+                    n->cost[1] = c;
+                    n->rule[1] = 16;
+                }
+            }
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->cost[1] < SEL_INF) {
+                c = 1 + n->kid[0]->cost[1] + n->kid[1]->cost[1];
+                if (c < n->cost[1]) {
+                    n->cost[1] = c;
+                    n->rule[1] = 17;
+                }
+            }
+            break;
+        case SEL_MINUS:
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->cost[3] < SEL_INF) {
+                c = 1 + n->kid[0]->cost[1] + n->kid[1]->cost[3];
+                if (c < n->cost[1]) {
+                    n->cost[1] = c;
+                    n->rule[1] = 18;
+                }
+            }
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->cost[1] < SEL_INF) {
+                c = 1 + n->kid[0]->cost[1] + n->kid[1]->cost[1];
+                if (c < n->cost[1]) {
+                    n->cost[1] = c;
+                    n->rule[1] = 19;
+                }
+            }
+            break;
+        case SEL_MUL:
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->op == SEL_POW2) {
+                c = 1 + n->kid[0]->cost[1];
+                if (c < n->cost[1]) {
+                    n->cost[1] = c;
+                    n->rule[1] = 20;
+                }
+            }
+            if (1 && n->kid[0]->op == SEL_POW2 && n->kid[1]->cost[1] < SEL_INF) {
+                c = 1 + n->kid[1]->cost[1];
+                if (c < n->cost[1]) {
+                    n->cost[1] = c;
+                    n->rule[1] = 21;
+                }
+            }
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->cost[1] < SEL_INF) {
+                c = 1 + n->kid[0]->cost[1] + n->kid[1]->cost[1];
+                if (c < n->cost[1]) {
+                    n->cost[1] = c;
+                    n->rule[1] = 22;
+                }
+            }
+            break;
+        case SEL_DIV:
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->op == SEL_POW2) {
+                c = 4 + n->kid[0]->cost[1];
+                if (c < n->cost[1]) {
+                    n->cost[1] = c;
+                    n->rule[1] = 23;
+                }
+            }
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->cost[1] < SEL_INF) {
+                c = 4 + n->kid[0]->cost[1] + n->kid[1]->cost[1];
+                if (c < n->cost[1]) {
+                    n->cost[1] = c;
+                    n->rule[1] = 24;
+                }
+            }
+            break;
+        case SEL_NEG:
+            if (1 && n->kid[0]->cost[1] < SEL_INF) {
+                c = 1 + n->kid[0]->cost[1];
+                if (c < n->cost[1]) {
+                    n->cost[1] = c;
+                    n->rule[1] = 25;
+                }
+            }
+            break;
+        case SEL_ASSG:
+            if (1 && n->kid[0]->cost[1] < SEL_INF) {
+                c = 0 + n->kid[0]->cost[1];
+                if (c < n->cost[1]) {
+                    n->cost[1] = c;
+                    n->rule[1] = 11;
+                }
+            }
+            if (1 && n->kid[0]->cost[3] < SEL_INF) {
+                c = 1 + n->kid[0]->cost[3];
+                if (c < n->cost[1]) {
+                    n->cost[1] = c;
+                    n->rule[1] = 12;
+                }
+            }
+            if (1 && n->kid[0]->op == SEL_CON) {
+                c = 2;
+                if (c < n->cost[1]) {
+                    n->cost[1] = c;
+                    n->rule[1] = 13;
+                }
+            }
+            if (1 && n->kid[0]->cost[2] < SEL_INF) {
+                c = 1 + n->kid[0]->cost[2];
+                if (c < n->cost[1]) {
+                    n->cost[1] = c;
+                    n->rule[1] = 14;
+                }
+            }
+            break;
+        case SEL_EQ:
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->op == SEL_ZERO) {
+                c = 1 + n->kid[0]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 26;
+                }
+            }
+            if (1 && n->kid[0]->op == SEL_ZERO && n->kid[1]->cost[1] < SEL_INF) {
+                c = 1 + n->kid[1]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 32;
+                }
+            }
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->cost[4] < SEL_INF) {
+                c = 2 + n->kid[0]->cost[1] + n->kid[1]->cost[4];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 38;
+                }
+            }
+            if (1 && n->kid[0]->cost[4] < SEL_INF && n->kid[1]->cost[1] < SEL_INF) {
+                c = 2 + n->kid[0]->cost[4] + n->kid[1]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 44;
+                }
+            }
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->cost[1] < SEL_INF) {
+                c = 1 + n->kid[0]->cost[1] + n->kid[1]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 50;
+                }
+            }
+            break;
+        case SEL_NE:
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->op == SEL_ZERO) {
+                c = 1 + n->kid[0]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 27;
+                }
+            }
+            if (1 && n->kid[0]->op == SEL_ZERO && n->kid[1]->cost[1] < SEL_INF) {
+                c = 1 + n->kid[1]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 33;
+                }
+            }
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->cost[4] < SEL_INF) {
+                c = 2 + n->kid[0]->cost[1] + n->kid[1]->cost[4];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 39;
+                }
+            }
+            if (1 && n->kid[0]->cost[4] < SEL_INF && n->kid[1]->cost[1] < SEL_INF) {
+                c = 2 + n->kid[0]->cost[4] + n->kid[1]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 45;
+                }
+            }
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->cost[1] < SEL_INF) {
+                c = 1 + n->kid[0]->cost[1] + n->kid[1]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 51;
+                }
+            }
+            break;
+        case SEL_LT:
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->op == SEL_ZERO) {
+                c = 1 + n->kid[0]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 28;
+                }
+            }
+            if (1 && n->kid[0]->op == SEL_ZERO && n->kid[1]->cost[1] < SEL_INF) {
+                c = 1 + n->kid[1]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 34;
+                }
+            }
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->cost[4] < SEL_INF) {
+                c = 2 + n->kid[0]->cost[1] + n->kid[1]->cost[4];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 40;
+                }
+            }
+            if (1 && n->kid[0]->cost[4] < SEL_INF && n->kid[1]->cost[1] < SEL_INF) {
+                c = 2 + n->kid[0]->cost[4] + n->kid[1]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 46;
+                }
+            }
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->cost[1] < SEL_INF) {
+                c = 1 + n->kid[0]->cost[1] + n->kid[1]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 52;
+                }
+            }
+            break;
+        case SEL_LE:
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->op == SEL_ZERO) {
+                c = 1 + n->kid[0]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 29;
+                }
+            }
+            if (1 && n->kid[0]->op == SEL_ZERO && n->kid[1]->cost[1] < SEL_INF) {
+                c = 1 + n->kid[1]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 35;
+                }
+            }
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->cost[4] < SEL_INF) {
+                c = 2 + n->kid[0]->cost[1] + n->kid[1]->cost[4];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 41;
+                }
+            }
+            if (1 && n->kid[0]->cost[4] < SEL_INF && n->kid[1]->cost[1] < SEL_INF) {
+                c = 2 + n->kid[0]->cost[4] + n->kid[1]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 47;
+                }
+            }
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->cost[1] < SEL_INF) {
+                c = 1 + n->kid[0]->cost[1] + n->kid[1]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 53;
+                }
+            }
+            break;
+        case SEL_GT:
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->op == SEL_ZERO) {
+                c = 1 + n->kid[0]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 30;
+                }
+            }
+            if (1 && n->kid[0]->op == SEL_ZERO && n->kid[1]->cost[1] < SEL_INF) {
+                c = 1 + n->kid[1]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 36;
+                }
+            }
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->cost[4] < SEL_INF) {
+                c = 2 + n->kid[0]->cost[1] + n->kid[1]->cost[4];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 42;
+                }
+            }
+            if (1 && n->kid[0]->cost[4] < SEL_INF && n->kid[1]->cost[1] < SEL_INF) {
+                c = 2 + n->kid[0]->cost[4] + n->kid[1]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 48;
+                }
+            }
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->cost[1] < SEL_INF) {
+                c = 1 + n->kid[0]->cost[1] + n->kid[1]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 54;
+                }
+            }
+            break;
+        case SEL_GE:
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->op == SEL_ZERO) {
+                c = 1 + n->kid[0]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 31;
+                }
+            }
+            if (1 && n->kid[0]->op == SEL_ZERO && n->kid[1]->cost[1] < SEL_INF) {
+                c = 1 + n->kid[1]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 37;
+                }
+            }
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->cost[4] < SEL_INF) {
+                c = 2 + n->kid[0]->cost[1] + n->kid[1]->cost[4];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 43;
+                }
+            }
+            if (1 && n->kid[0]->cost[4] < SEL_INF && n->kid[1]->cost[1] < SEL_INF) {
+                c = 2 + n->kid[0]->cost[4] + n->kid[1]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 49;
+                }
+            }
+            if (1 && n->kid[0]->cost[1] < SEL_INF && n->kid[1]->cost[1] < SEL_INF) {
+                c = 1 + n->kid[0]->cost[1] + n->kid[1]->cost[1];
+                if (c < n->cost[5]) {
+                    n->cost[5] = c;
+                    n->rule[5] = 55;
+                }
+            }
+            break;
+        case SEL_REG:
+            if (1) {
+                c = 0;
+                if (c < n->cost[1]) {
+                    n->cost[1] = c;
+                    n->rule[1] = 0;
+                }
+            }
+            break;
+        case SEL_MEM:
+            if (1) {
+                c = 0;
+                if (c < n->cost[2]) {
+                    n->cost[2] = c;
+                    n->rule[2] = 1;
+                }
+            }
+            break;
+        case SEL_ZERO:
+            if (1) {
+                c = 0;
+                if (c < n->cost[1]) {
+                    n->cost[1] = c;
+                    n->rule[1] = 3;
+                }
+            }
+            if (1) {
+                c = 0;
+                if (c < n->cost[3]) {
+                    n->cost[3] = c;
+                    n->rule[3] = 4;
+                }
+            }
+            break;
+        case SEL_POW2:
+            if (1) {
+                c = 0;
+                if (c < n->cost[3]) {
+                    n->cost[3] = c;
+                    n->rule[3] = 5;
+                }
+            }
+            break;
+        case SEL_IMM16:
+            if (1) {
+                c = 0;
+                if (c < n->cost[3]) {
+                    n->cost[3] = c;
+                    n->rule[3] = 6;
+                }
+            }
+            break;
+        case SEL_CON:
+            if (1) {
+                c = 0;
+                if (c < n->cost[4]) {
+                    n->cost[4] = c;
+                    n->rule[4] = 8;
+                }
+            }
+            if (1) {
+                c = 2;
+                if (c < n->cost[1]) {
+                    n->cost[1] = c;
+                    n->rule[1] = 10;
+                }
+            }
+            break;
+    }
+
+    sel_closure(n);
+}
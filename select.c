@@ -0,0 +1,197 @@
+/*
+ * File: select.c
+ * Author: Maria Fay Garcia
+ * Purpose: Select the mips instructions for the arithmetic, copies and
+ *          branches of the three address code.  Each instr is a tree, an
+ *          operator over the leaves for its operands, labeled bottom-up
+ *          with the cheapest rule of sel_table.h for each nonterminal,
+ *          then reduced from its root, printing the code of each rule.
+ *          The rules and their costs are in sel_gen.c.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "select.h"
+#include "regalloc.h"
+#include "arena.h"
+#include "asm.h"
+#include "sel_table.h"
+
+// the instr being covered, for the label of a branch
+static Instr *cur_instr;
+
+// the terminal for each operator of the three address code, -1 for the
+// ones translated by hand
+static int sel_op(OpType op) {
+    switch (op) {
+        case OP_PLUS:        return SEL_PLUS;
+        case OP_MINUS:       return SEL_MINUS;
+        case OP_MUL:         return SEL_MUL;
+        case OP_DIV:         return SEL_DIV;
+        case OP_UNARY_MINUS: return SEL_NEG;
+        case OP_ASSG:        return SEL_ASSG;
+        case OP_EQ:          return SEL_EQ;
+        case OP_NE:          return SEL_NE;
+        case OP_LT:          return SEL_LT;
+        case OP_LE:          return SEL_LE;
+        case OP_GT:          return SEL_GT;
+        case OP_GE:          return SEL_GE;
+        default:             return -1;
+    }
+}
+
+// the leaf for an operand: a constant, by the immediates it fits,
+// or a value in a register or in memory
+// a temp made again where it is read is its constant
+static void label_leaf(SelNode *n, Operand op) {
+    n->opnd   = op;
+    n->kid[0] = n->kid[1] = NULL;
+
+    int val;
+    if (OPND_TYPE(op) == ICONST || remat_const(op, &val)) {
+        if (OPND_TYPE(op) == ICONST) val = OPND_INT(op);
+        n->val = val;
+        if (val == 0) {
+            n->op = SEL_ZERO;
+        } else if (val >= 2 && val <= 16384 && (val & (val - 1)) == 0) {
+            n->op = SEL_POW2;
+        } else if (val >= -32767 && val <= 32767) {
+            // -val fits too, for x - c
+            n->op = SEL_IMM16;
+        } else {
+            n->op = SEL_CON;
+        }
+    } else if (operand_reg(op) >= 0) {
+        n->op = SEL_REG;
+    } else {
+        n->op = SEL_MEM;
+    } sel_label(n);
+}
+
+static int log2_of(int val) {
+    int k = 0;
+    while ((1 << k) < val) k++;
+    return k;
+}
+
+// the text of a terminal leaf
+static char *leaf_text(SelNode *n) {
+    switch (n->op) {
+        case SEL_REG: return reg_name[operand_reg(n->opnd)];
+        case SEL_MEM: return get_operand_loc(n->opnd);
+        default:      return arena_sprintf(&func_arena, "%d", n->val);
+    }
+}
+
+// fill in the template of the rule n is rewritten by: print its code and
+// return the register it is left in, or for "=x" return x
+static char *expand(char *tmpl, SelNode *n, char *reg, SelNode **leaves, char **vals) {
+    char  buf[256];
+    char *o = buf;
+
+    int is_value = tmpl[0] == '=';
+    for (char *s = tmpl + is_value; *s; s++) {
+        if (*s == ';') {
+            *o++ = '\n';
+            while (s[1] == ' ') s++;
+            continue;
+        } else if (*s != '%') {
+            *o++ = *s;
+            continue;
+        }
+
+        s++;
+        switch (*s) {
+            case 'd': o += sprintf(o, "%s", reg);                                  break;
+            case 'c': o += sprintf(o, "%d", n->val);                               break;
+            case 'm': o += sprintf(o, "%s", get_operand_loc(n->opnd));             break;
+            case 'r': o += sprintf(o, "%s", reg_name[operand_reg(n->opnd)]);      break;
+            case 'L': o += sprintf(o, "L%d", OPND_INT(cur_instr->dest));           break;
+            case 'n': s++; o += sprintf(o, "%d", -leaves[*s - '0']->val);          break;
+            case 'k': s++; o += sprintf(o, "%d", log2_of(leaves[*s - '0']->val));  break;
+            case 'j': s++; o += sprintf(o, "%d", 32 - log2_of(leaves[*s - '0']->val)); break;
+            default:       o += sprintf(o, "%s", vals[*s - '0']);                  break;
+        }
+    } *o = 0;
+
+    if (is_value) return arena_sprintf(&func_arena, "%s", buf);
+    emit("%s\n", buf);
+    return reg;
+}
+
+// print the code for n rewritten to nonterminal nt, computing it in reg
+// if it needs one, and return where its value is
+// the leaves under the root are loaded into $t0 or $t1, by their side
+static char *reduce(SelNode *n, int nt, char *reg) {
+    const SelRule *rule = &sel_rules[n->rule[nt]];
+    SelNode       *leaves[SEL_MAX_LEAVES];
+    char          *vals[SEL_MAX_LEAVES];
+
+    if (rule->chain) {
+        leaves[0] = n;
+        vals[0]   = reduce(n, rule->chain, reg);
+    } else {
+        for (int k = 0; k < rule->num_leaves; k++) {
+            SelNode *leaf = n;
+            for (char *p = rule->leaf_path[k]; *p; p++) leaf = leaf->kid[*p - '0'];
+
+            leaves[k] = leaf;
+            if (rule->leaf_nt[k]) {
+                char *scratch = rule->leaf_path[k][0] == '1' ? "$t1" : "$t0";
+                vals[k] = reduce(leaf, rule->leaf_nt[k], scratch);
+            } else {
+                vals[k] = leaf_text(leaf);
+            }
+        }
+    } return expand(rule->tmpl, n, reg, leaves, vals);
+}
+
+// translate instr by the rule table, if it covers its operator
+int select_instr(Instr *instr) {
+    int op = sel_op(instr->op);
+    if (op < 0) return 0;
+
+    // a temp made again where it is read is not set at all
+    Operand dest = instr->dest;
+    int val;
+    if (remat_const(dest, &val)) {
+        emit("\n");
+        return 1;
+    }
+
+    // the tree: the operator over a leaf for each source
+    SelNode leaves[2], root;
+    root.op = op;
+    root.kid[0] = &leaves[0];
+    root.kid[1] = OPND_TYPE(instr->src2) != NO_OPERAND ? &leaves[1] : NULL;
+    label_leaf(&leaves[0], instr->src1);
+    if (root.kid[1]) label_leaf(&leaves[1], instr->src2);
+    sel_label(&root);
+
+    int is_branch = instr->op >= OP_EQ && instr->op <= OP_GE;
+    int nt = is_branch ? SEL_NT_stmt : SEL_NT_reg;
+    if (root.cost[nt] >= SEL_INF) {
+        fprintf(stderr, "no instructions cover %s\n", op_name[instr->op]);
+        exit(1);
+    }
+
+    cur_instr = instr;
+    if (is_branch) {
+        reduce(&root, nt, NULL);
+        emit("\n");
+        return 1;
+    }
+
+    // compute the value in the register dest was given, or in $t0 to
+    // store it; a copy may leave it in the register of its source
+    int   reg      = operand_reg(dest);
+    char *dest_reg = reg >= 0 ? reg_name[reg] : "$t0";
+    char *result   = reduce(&root, nt, dest_reg);
+    if (reg < 0) {
+        emit("sw %s, %s\n", result, get_operand_loc(dest));
+    } else if (strcmp(result, dest_reg) != 0) {
+        emit("move %s, %s\n", dest_reg, result);
+    }
+    emit("\n");
+    return 1;
+}
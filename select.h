@@ -0,0 +1,47 @@
+/*
+ * File: select.h
+ * Author: Maria Fay Garcia
+ * Purpose: To outline the instruction selector, which covers the tree
+ *          of each arithmetic, copy and branch instr with the cheapest
+ *          mips patterns of the rule table in sel_gen.c
+ */
+#ifndef __SELECT_H__
+#define __SELECT_H__
+
+#include "code_gen.h"
+
+// the most nonterminals and leaves a rule table may have
+#define SEL_MAX_NTS     8
+#define SEL_MAX_LEAVES  3
+
+// a cost too big to reach, for a nonterminal a node cannot be rewritten to
+#define SEL_INF 0x3fffffff
+
+// a rule of the table, as sel_gen lays it out in sel_table.h
+// a leaf is reached from the root of the pattern by the kids in its path
+typedef struct {
+    int   lhs;
+    int   chain;                            // the nonterminal of a chain rule, else 0
+    int   cost;
+    int   num_leaves;
+    char *leaf_path[SEL_MAX_LEAVES];
+    int   leaf_nt  [SEL_MAX_LEAVES];        // 0 for a terminal
+    char *tmpl;
+} SelRule;
+
+// a node of the tree being covered: an operator over its kids, or a leaf
+// for an operand; the labeler fills in the cheapest rule to rewrite it
+// to each nonterminal, and its cost
+typedef struct SelNode {
+    int             op;
+    struct SelNode *kid[2];
+    Operand         opnd;
+    int             val;                    // the value of a constant leaf
+    int             cost[SEL_MAX_NTS];
+    int             rule[SEL_MAX_NTS];
+} SelNode;
+
+// function stubs
+int      select_instr    (Instr           *instr);
+
+#endif  /* __SELECT_H__ */
@@ -0,0 +1,55 @@
+/*
+ * File: source.c
+ * Author: Maria Fay Garcia
+ * Purpose: Map the source file (or slurp a pipe) into one buffer
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "source.h"
+
+#define READ_CHUNK 65536
+
+// globals
+char *src_buf = NULL;
+int   src_len = 0;
+int   src_pos = 0;
+
+// read everything from fd into a growable buffer (pipes, terminals)
+static void read_source(int fd) {
+    int cap = READ_CHUNK;
+    src_buf = (char *)malloc(cap);
+    src_len = 0;
+
+    while (1) {
+        if (src_len == cap) {
+            cap *= 2;
+            src_buf = (char *)realloc(src_buf, cap);
+        }
+
+        ssize_t n = read(fd, src_buf + src_len, cap - src_len);
+        if (n <= 0) break;
+        src_len += n;
+    }
+}
+
+// make the whole source available in src_buf
+// regular files are mapped, anything else is read into memory
+void load_source(int fd) {
+    struct stat st;
+    src_pos = 0;
+
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            madvise(map, st.st_size, MADV_SEQUENTIAL);
+            src_buf = (char *)map;
+            src_len = st.st_size;
+            return;
+        }
+    }
+
+    read_source(fd);
+}
@@ -0,0 +1,18 @@
+/*
+ * File: source.h
+ * Author: Maria Fay Garcia
+ * Purpose: Load the whole source program into memory once so the
+ *          scanner can work on slices of a single buffer
+ */
+#ifndef __SOURCE_H__
+#define __SOURCE_H__
+
+// globals
+extern char *src_buf;   // the source text (not NUL terminated)
+extern int   src_len;   // number of bytes in src_buf
+extern int   src_pos;   // offset of the next byte to be scanned
+
+// function stubs
+void  load_source(int    fd                 );
+
+#endif  /* __SOURCE_H__ */
@@ -0,0 +1,1214 @@
+/*
+ * File: ssa.c
+ * Author: Maria Fay Garcia
+ * Purpose: The SSA tier of the optimizer: put the three address code of
+ *          a function in static single assignment form, propagate
+ *          constants over the edges that can be taken, number values
+ *          down the dominator tree, and take the code back out of SSA
+ */
+#include <limits.h>
+#include "ssa.h"
+#include "opt.h"
+#include "dataflow.h"
+#include "arena.h"
+
+// functions that would need more phis than this, liveness sets of more
+// words, or more interference edges are left as they are
+#define SSA_MAX_PHIS  (1 << 20)
+#define SSA_MAX_WORDS (1 << 20)
+#define SSA_MAX_EDGES (1 << 22)
+
+static int  to_ssa();
+static void sccp();
+static void gvn();
+static void ssa_dce();
+static int  from_ssa();
+
+// run the tier over ir; a function it can't take is left alone
+void ssa_optimize() {
+    build_cfg();
+    if (cfg.count == 0 || cfg.block[0].num_pred > 0 || ir.instr[0].op != OP_ENTER) return;
+
+    // keep the code to go back to
+    Instr *saved      = (Instr *)arena_alloc(&func_arena, ir.count * sizeof(Instr));
+    int   saved_count = ir.count;
+    int   saved_temps = tmp_num;
+    memcpy(saved, ir.instr, ir.count * sizeof(Instr));
+
+    if (to_ssa()) {
+        sccp();
+        gvn();
+        ssa_dce();
+        if (from_ssa()) {
+            number_vars();
+            return;
+        }
+    }
+
+    memcpy(ir.instr, saved, saved_count * sizeof(Instr));
+    ir.count = saved_count;
+    tmp_num  = saved_temps;
+}
+
+
+/*************** SSA FORM *****************/
+
+/*
+ * In SSA form the locals and params are gone from the code.  Every def
+ * of one sets a new temp, a version of it, and every use reads the
+ * version that reaches it; where versions meet at the top of a block, a
+ * phi picks the one of the edge control came in on.  The temps of
+ * lowering are already set once, and stay.  Globals stay in memory,
+ * since a call may change them.
+ *
+ * The version a variable has on entry, what is in its slot, is set by no
+ * instr; it is loaded after the enter when the code comes out of SSA.
+ */
+typedef struct {
+    int      dest;      // the value it sets, -1 once it is removed
+    int      var;
+    int      block;
+    Operand *args;      // one per pred of block, NO_OPERAND for an edge not taken
+} Phi;
+
+static Phi  *phis;
+static int   num_phis;
+static int  *blk_phi;       // block b's phis are phis[blk_phi[b] .. blk_phi[b + 1])
+
+// the values are the temps 0 .. num_vals - 1
+static int   num_vals;
+static int   max_vals;
+static int  *val_var;       // the variable a value is a version of, -1 for a temp of lowering
+static int  *val_def;       // the instr that sets it, -(p + 1) for phi p, DEF_ENTRY
+static int  *entry_val;     // the version each variable has on entry, -1 if it is not renamed
+static int  *instr_block;   // the block of each instr
+
+#define DEF_ENTRY INT_MIN
+
+static int new_val(int var, int def) {
+    val_var[num_vals] = var;
+    val_def[num_vals] = def;
+    return num_vals++;
+}
+
+static Operand temp_operand(int v) { return new_operand(TEMP, (void *)&v); }
+
+// whether SSA form renames var: the locals and params, which nothing
+// but this function's code can read or set
+static int is_renamed(int var) { return var >= 0 && vars[var]->scope == LOCAL; }
+
+// block b's dominance frontier is df_blocks[df_first[b] .. df_first[b + 1]):
+// the blocks just past the part of the graph b dominates
+static int *df_first;
+static int *df_blocks;
+
+// walk up the dominator tree from each pred of a join to the join's idom
+// (Cooper, Harvey and Kennedy); the join is in the frontier of each block
+// on the way.  Once a block has it, so do those above it
+static void find_frontiers() {
+    int n = cfg.count;
+    int *last = (int *)arena_alloc(&func_arena, (n + 1) * sizeof(int));
+    int *fill = (int *)arena_alloc(&func_arena, (n + 1) * sizeof(int));
+    df_first  = (int *)arena_alloc(&func_arena, (n + 1) * sizeof(int));
+
+    for (int pass = 0; pass < 2; pass++) {
+        for (int b = 0; b < n; b++) last[b] = -1;
+        for (int b = 0; b < n; b++) {
+            Block *block = &cfg.block[b];
+            if (cfg.idom[b] < 0 || block->num_pred < 2) continue;
+            for (int k = 0; k < block->num_pred; k++) {
+                if (cfg.idom[block->pred[k]] < 0) continue;
+                for (int r = block->pred[k]; r != cfg.idom[b] && last[r] != b; r = cfg.idom[r]) {
+                    last[r] = b;
+                    if (pass == 0) {
+                        df_first[r]++;
+                    } else {
+                        df_blocks[fill[r]++] = b;
+                    }
+                }
+            }
+        }
+
+        if (pass == 0) {
+            for (int b = 0, start = 0; b <= n; b++) {
+                int count = df_first[b];
+                df_first[b] = fill[b] = start;
+                start += count;
+            } df_blocks = (int *)arena_alloc(&func_arena, (df_first[n] + 1) * sizeof(int));
+        }
+    }
+}
+
+// put a phi for each renamed variable at the iterated frontier of the
+// blocks that set it (the entry sets them all).  Variables no block reads
+// before setting it are never live across blocks and get none
+// returns 0 if there would be too many
+static int place_phis() {
+    int n = cfg.count;
+    char *exposed   = (char *)arena_alloc(&func_arena, num_vars + 1);
+    int  *stamp     = (int *)arena_alloc(&func_arena, (num_vars + 1) * sizeof(int));
+    int  *def_first = (int *)arena_alloc(&func_arena, (num_vars + 2) * sizeof(int));
+    int  *fill      = (int *)arena_alloc(&func_arena, (num_vars + 1) * sizeof(int));
+    int  *def_blocks = NULL;
+
+    // the blocks each variable is set in, as one list per variable
+    for (int pass = 0; pass < 2; pass++) {
+        for (int v = 0; v < num_vars; v++) stamp[v] = -1;
+        for (int b = 0; b < n; b++) {
+            if (cfg.rpo_num[b] < 0) continue;
+            for (int i = cfg.block[b].first; i < cfg.block[b].end; i++) {
+                Instr *instr = &ir.instr[i];
+                int var = named_var(instr->src1);
+                if (is_renamed(var) && stamp[var] != b) exposed[var] = 1;
+                var = named_var(instr->src2);
+                if (is_renamed(var) && stamp[var] != b) exposed[var] = 1;
+
+                var = instr_def(instr);
+                if (!is_renamed(var) || stamp[var] == b) continue;
+                stamp[var] = b;
+                if (pass == 0) {
+                    def_first[var]++;
+                } else {
+                    def_blocks[fill[var]++] = b;
+                }
+            }
+        }
+
+        if (pass == 0) {
+            for (int v = 0, start = 0; v <= num_vars; v++) {
+                int count = def_first[v];
+                def_first[v] = fill[v] = start;
+                start += count;
+            } def_blocks = (int *)arena_alloc(&func_arena, (def_first[num_vars] + 1) * sizeof(int));
+        }
+    }
+
+    // the (block, variable) of each phi, in the order they are found
+    int  cap     = 64;
+    int *phi_blk = (int *)arena_alloc(&func_arena, cap * sizeof(int));
+    int *phi_var = (int *)arena_alloc(&func_arena, cap * sizeof(int));
+    int *has_phi = (int *)arena_alloc(&func_arena, n * sizeof(int));
+    int *queued  = (int *)arena_alloc(&func_arena, n * sizeof(int));
+    int *work    = (int *)arena_alloc(&func_arena, (n + 1) * sizeof(int));
+    for (int b = 0; b < n; b++) has_phi[b] = queued[b] = -1;
+
+    num_phis = 0;
+    for (int v = 0; v < num_vars; v++) {
+        if (!is_renamed(v) || !exposed[v]) continue;
+
+        int nwork = 0;
+        queued[0] = v;
+        work[nwork++] = 0;
+        for (int k = def_first[v]; k < def_first[v + 1]; k++) {
+            int b = def_blocks[k];
+            if (queued[b] == v) continue;
+            queued[b] = v;
+            work[nwork++] = b;
+        }
+
+        while (nwork > 0) {
+            int b = work[--nwork];
+            for (int k = df_first[b]; k < df_first[b + 1]; k++) {
+                int d = df_blocks[k];
+                if (has_phi[d] == v) continue;
+                has_phi[d] = v;
+
+                if (num_phis == SSA_MAX_PHIS) return 0;
+                if (num_phis == cap) {
+                    int *blk = (int *)arena_alloc(&func_arena, 2 * cap * sizeof(int));
+                    int *var = (int *)arena_alloc(&func_arena, 2 * cap * sizeof(int));
+                    memcpy(blk, phi_blk, cap * sizeof(int));
+                    memcpy(var, phi_var, cap * sizeof(int));
+                    phi_blk = blk;
+                    phi_var = var;
+                    cap *= 2;
+                }
+                phi_blk[num_phis]   = d;
+                phi_var[num_phis++] = v;
+
+                if (queued[d] != v) {
+                    queued[d] = v;
+                    work[nwork++] = d;
+                }
+            }
+        }
+    }
+
+    // sort them by block, each with room for an arg per pred
+    blk_phi = (int *)arena_alloc(&func_arena, (n + 2) * sizeof(int));
+    for (int p = 0; p < num_phis; p++) blk_phi[phi_blk[p]]++;
+    for (int b = 0, start = 0; b <= n; b++) {
+        int count = blk_phi[b];
+        blk_phi[b] = start;
+        start += count;
+    }
+
+    phis = (Phi *)arena_alloc(&func_arena, (num_phis + 1) * sizeof(Phi));
+    int *place = (int *)arena_alloc(&func_arena, (n + 1) * sizeof(int));
+    memcpy(place, blk_phi, n * sizeof(int));
+    for (int p = 0; p < num_phis; p++) {
+        Phi *phi   = &phis[place[phi_blk[p]]++];
+        phi->var   = phi_var[p];
+        phi->block = phi_blk[p];
+        phi->args  = (Operand *)arena_alloc(&func_arena, (cfg.block[phi->block].num_pred + 1) * sizeof(Operand));
+    } return 1;
+}
+
+static void rename_use(Operand *op, int *cur) {
+    int var = named_var(*op);
+    if (is_renamed(var)) *op = temp_operand(cur[var]);
+}
+
+// give each def of a renamed variable a new value, and each use the one
+// that reaches it: walk the dominator tree, keeping the version of each
+// variable as of the block being renamed
+static void rename_vars() {
+    int n = cfg.count;
+
+    // the children of each block in the dominator tree
+    int *kid_first = (int *)arena_alloc(&func_arena, (n + 2) * sizeof(int));
+    int *kids      = (int *)arena_alloc(&func_arena, (n + 1) * sizeof(int));
+    int *fill      = (int *)arena_alloc(&func_arena, (n + 1) * sizeof(int));
+    for (int b = 1; b < n; b++) {
+        if (cfg.idom[b] >= 0) kid_first[cfg.idom[b]]++;
+    }
+    for (int b = 0, start = 0; b <= n; b++) {
+        int count = kid_first[b];
+        kid_first[b] = fill[b] = start;
+        start += count;
+    }
+    for (int b = 1; b < n; b++) {
+        if (cfg.idom[b] >= 0) kids[fill[cfg.idom[b]]++] = b;
+    }
+
+    int *cur = (int *)arena_alloc(&func_arena, (num_vars + 1) * sizeof(int));
+    entry_val = (int *)arena_alloc(&func_arena, (num_vars + 1) * sizeof(int));
+    for (int v = 0; v < num_vars; v++) {
+        entry_val[v] = is_renamed(v) ? new_val(v, DEF_ENTRY) : -1;
+        cur[v] = entry_val[v];
+    }
+
+    // the versions a block replaced, put back when the walk leaves it
+    int *undo_var = (int *)arena_alloc(&func_arena, (max_vals + 1) * sizeof(int));
+    int *undo_val = (int *)arena_alloc(&func_arena, (max_vals + 1) * sizeof(int));
+    int *undo_top = (int *)arena_alloc(&func_arena, (n + 1) * sizeof(int));
+    int  num_undo = 0;
+
+    // a block on the stack is entered, its complement left
+    int *stack = (int *)arena_alloc(&func_arena, (2 * n + 1) * sizeof(int));
+    int  sp    = 0;
+    stack[sp++] = 0;
+    while (sp > 0) {
+        int b = stack[--sp];
+        if (b < 0) {
+            for (b = ~b; num_undo > undo_top[b]; num_undo--) {
+                cur[undo_var[num_undo - 1]] = undo_val[num_undo - 1];
+            } continue;
+        }
+
+        undo_top[b] = num_undo;
+        stack[sp++] = ~b;
+
+        for (int p = blk_phi[b]; p < blk_phi[b + 1]; p++) {
+            int var = phis[p].var;
+            undo_var[num_undo]   = var;
+            undo_val[num_undo++] = cur[var];
+            cur[var] = phis[p].dest = new_val(var, -(p + 1));
+        }
+
+        for (int i = cfg.block[b].first; i < cfg.block[b].end; i++) {
+            Instr *instr = &ir.instr[i];
+            rename_use(&instr->src1, cur);
+            rename_use(&instr->src2, cur);
+
+            int var = instr_def(instr);
+            if (!is_renamed(var)) continue;
+            undo_var[num_undo]   = var;
+            undo_val[num_undo++] = cur[var];
+            cur[var] = new_val(var, i);
+            instr->dest = temp_operand(cur[var]);
+        }
+
+        // this block's args to the phis of its succs
+        for (int k = 0; k < 2; k++) {
+            int s = cfg.block[b].succ[k];
+            if (s < 0 || (k == 1 && s == cfg.block[b].succ[0])) continue;
+            for (int j = 0; j < cfg.block[s].num_pred; j++) {
+                if (cfg.block[s].pred[j] != b) continue;
+                for (int p = blk_phi[s]; p < blk_phi[s + 1]; p++) {
+                    phis[p].args[j] = temp_operand(cur[phis[p].var]);
+                }
+            }
+        }
+
+        for (int k = kid_first[b]; k < kid_first[b + 1]; k++) stack[sp++] = kids[k];
+    }
+}
+
+// put ir in SSA form
+// returns 0 if the function is too large to
+static int to_ssa() {
+    number_vars();
+    find_dominators();
+    find_frontiers();
+    if (!place_phis()) return 0;
+
+    instr_block = (int *)arena_alloc(&func_arena, (ir.count + 1) * sizeof(int));
+    int defs = 0;
+    for (int b = 0; b < cfg.count; b++) {
+        for (int i = cfg.block[b].first; i < cfg.block[b].end; i++) {
+            instr_block[i] = b;
+            if (is_renamed(instr_def(&ir.instr[i]))) defs++;
+        }
+    }
+
+    // room for the values made here, and a value per phi when the code
+    // goes back out of SSA
+    num_vals = tmp_num;
+    max_vals = tmp_num + num_vars + defs + 2 * num_phis;
+    val_var  = (int *)arena_alloc(&func_arena, (max_vals + 1) * sizeof(int));
+    val_def  = (int *)arena_alloc(&func_arena, (max_vals + 1) * sizeof(int));
+    for (int v = 0; v < tmp_num; v++) {
+        val_var[v] = -1;
+        val_def[v] = DEF_ENTRY;
+    }
+    for (int i = 0; i < ir.count; i++) {
+        if (OPND_TYPE(ir.instr[i].dest) == TEMP) val_def[OPND_INT(ir.instr[i].dest)] = i;
+    }
+
+    rename_vars();
+    return 1;
+}
+
+
+/*************** CONSTANT PROPAGATION *****************/
+
+/*
+ * Sparse conditional constant propagation (Wegman and Zadeck): a value
+ * is looked at again only when one it is computed from changes, and a
+ * block only once control is found to reach it, so a value set on a path
+ * that can't be taken doesn't spoil a phi, and a branch on a constant
+ * leaves the code behind the other edge out.
+ */
+static LatVal *lat;
+static char   *edge_exec;   // whether edge k out of block b may be taken, at 2 * b + k
+static char   *blk_exec;
+static int    *val_work;
+static int     num_val_work;
+static int    *blk_work;
+static int     num_blk_work;
+
+// the instrs (i) and phis (-(p + 1)) that read each value are
+// uses[use_first[v] .. use_first[v + 1])
+static int    *use_first;
+static int    *uses;
+
+static LatVal sccp_value(Operand op) {
+    switch (OPND_TYPE(op)) {
+        case ICONST: return lat_const(OPND_INT(op));
+        case TEMP:   return lat[OPND_INT(op)];
+        default:     return lat_bottom();
+    }
+}
+
+// lower what is known about value v to x
+static void sccp_set(int v, LatVal x) {
+    LatVal m = lat_meet(lat[v], x);
+    if (m.kind == lat[v].kind && m.val == lat[v].val) return;
+    lat[v] = m;
+    val_work[num_val_work++] = v;
+}
+
+// whether control may go from block p to block s
+static int edge_taken(int p, int s) {
+    Block *block = &cfg.block[p];
+    return (block->succ[0] == s && edge_exec[2 * p]) || (block->succ[1] == s && edge_exec[2 * p + 1]);
+}
+
+static void sccp_phi(int p) {
+    Phi *phi = &phis[p];
+    Block *block = &cfg.block[phi->block];
+    LatVal x = { TOP, 0 };
+    for (int j = 0; j < block->num_pred; j++) {
+        if (edge_taken(block->pred[j], phi->block)) x = lat_meet(x, sccp_value(phi->args[j]));
+    } sccp_set(phi->dest, x);
+}
+
+// edge k out of block b may be taken
+static void sccp_edge(int b, int k) {
+    int s = cfg.block[b].succ[k];
+    if (s < 0 || edge_exec[2 * b + k]) return;
+    edge_exec[2 * b + k] = 1;
+
+    if (!blk_exec[s]) {
+        blk_exec[s] = 1;
+        blk_work[num_blk_work++] = s;
+    } else {
+        for (int p = blk_phi[s]; p < blk_phi[s + 1]; p++) sccp_phi(p);
+    }
+}
+
+// the value of an arithmetic instr, given those of its sources
+static LatVal sccp_fold(Instr *instr) {
+    LatVal a = sccp_value(instr->src1);
+    LatVal b = instr->op == OP_UNARY_MINUS ? lat_const(0) : sccp_value(instr->src2);
+    if (a.kind == BOTTOM || b.kind == BOTTOM) return lat_bottom();
+    if (a.kind == TOP    || b.kind == TOP)    return a.kind == TOP ? a : b;
+
+    int result;
+    if (fold_arith(instr->op, a.val, b.val, &result)) return lat_const(result);
+    return lat_bottom();
+}
+
+static void sccp_instr(int i) {
+    Instr *instr = &ir.instr[i];
+    int b = instr_block[i];
+    switch (instr->op) {
+        case OP_PLUS:
+        case OP_MINUS:
+        case OP_MUL:
+        case OP_DIV:
+        case OP_UNARY_MINUS:
+            if (OPND_TYPE(instr->dest) == TEMP) sccp_set(OPND_INT(instr->dest), sccp_fold(instr));
+            break;
+        case OP_ASSG:
+            if (OPND_TYPE(instr->dest) == TEMP) sccp_set(OPND_INT(instr->dest), sccp_value(instr->src1));
+            break;
+        case OP_GET_RETVAL:
+            if (OPND_TYPE(instr->dest) == TEMP) sccp_set(OPND_INT(instr->dest), lat_bottom());
+            break;
+        case OP_GOTO:
+            sccp_edge(b, 1);
+            break;
+        case OP_EQ:
+        case OP_NE:
+        case OP_LT:
+        case OP_LE:
+        case OP_GT:
+        case OP_GE:
+        {
+            LatVal x = sccp_value(instr->src1);
+            LatVal y = sccp_value(instr->src2);
+            if (x.kind == CONST && y.kind == CONST) {
+                sccp_edge(b, eval_comparison(instr->op, x.val, y.val));
+            } else if (x.kind == BOTTOM || y.kind == BOTTOM) {
+                sccp_edge(b, 0);
+                sccp_edge(b, 1);
+            } break;
+        }
+        default:
+            break;
+    }
+}
+
+static void sccp_subst(Operand *op) {
+    if (OPND_TYPE(*op) != TEMP) return;
+    LatVal x = lat[OPND_INT(*op)];
+    if (x.kind == CONST) *op = new_operand(ICONST, (void *)&x.val);
+}
+
+// rewrite the code with what is known, and drop what control can't reach
+static void sccp_rewrite() {
+    for (int b = 0; b < cfg.count; b++) {
+        if (!blk_exec[b]) {
+            for (int i = cfg.block[b].first; i < cfg.block[b].end; i++) ir.instr[i].op = OP_NOP;
+            for (int p = blk_phi[b]; p < blk_phi[b + 1]; p++) phis[p].dest = -1;
+            continue;
+        }
+
+        for (int p = blk_phi[b]; p < blk_phi[b + 1]; p++) {
+            for (int j = 0; j < cfg.block[b].num_pred; j++) {
+                if (edge_taken(cfg.block[b].pred[j], b)) {
+                    sccp_subst(&phis[p].args[j]);
+                } else {
+                    phis[p].args[j] = NO_OPERAND;
+                }
+            }
+        }
+
+        for (int i = cfg.block[b].first; i < cfg.block[b].end; i++) {
+            Instr *instr = &ir.instr[i];
+            if (is_pure_def(instr->op) && OPND_TYPE(instr->dest) == TEMP && lat[OPND_INT(instr->dest)].kind == CONST) {
+                // the whole instr is a constant
+                instr->op   = OP_ASSG;
+                instr->src1 = new_operand(ICONST, (void *)&lat[OPND_INT(instr->dest)].val);
+                instr->src2 = NO_OPERAND;
+                continue;
+            }
+
+            sccp_subst(&instr->src1);
+            sccp_subst(&instr->src2);
+            if (is_cond_branch(instr->op) && OPND_TYPE(instr->src1) == ICONST && OPND_TYPE(instr->src2) == ICONST) {
+                // the branch always or never jumps
+                instr->op   = eval_comparison(instr->op, OPND_INT(instr->src1), OPND_INT(instr->src2)) ? OP_GOTO : OP_NOP;
+                instr->src1 = NO_OPERAND;
+                instr->src2 = NO_OPERAND;
+            }
+        }
+    }
+}
+
+static void sccp() {
+    int n = cfg.count;
+    lat       = (LatVal *)arena_alloc(&func_arena, (num_vals + 1) * sizeof(LatVal));
+    edge_exec = (char *)arena_alloc(&func_arena, 2 * n + 1);
+    blk_exec  = (char *)arena_alloc(&func_arena, n + 1);
+    val_work  = (int *)arena_alloc(&func_arena, (2 * num_vals + 1) * sizeof(int));
+    blk_work  = (int *)arena_alloc(&func_arena, (n + 1) * sizeof(int));
+    num_val_work = num_blk_work = 0;
+
+    // nothing is known of what the variables hold on entry
+    for (int v = 0; v < num_vars; v++) {
+        if (entry_val[v] >= 0) lat[entry_val[v]] = lat_bottom();
+    }
+
+    // who reads each value
+    use_first = (int *)arena_alloc(&func_arena, (num_vals + 2) * sizeof(int));
+    int *fill = (int *)arena_alloc(&func_arena, (num_vals + 1) * sizeof(int));
+    for (int pass = 0; pass < 2; pass++) {
+        for (int b = 0; b < n; b++) {
+            if (cfg.rpo_num[b] < 0) continue;
+            for (int i = cfg.block[b].first; i < cfg.block[b].end; i++) {
+                Operand ops[2] = { ir.instr[i].src1, ir.instr[i].src2 };
+                for (int k = 0; k < 2; k++) {
+                    if (OPND_TYPE(ops[k]) != TEMP) continue;
+                    int v = OPND_INT(ops[k]);
+                    if (pass == 0) use_first[v]++; else uses[fill[v]++] = i;
+                }
+            }
+            for (int p = blk_phi[b]; p < blk_phi[b + 1]; p++) {
+                for (int j = 0; j < cfg.block[b].num_pred; j++) {
+                    if (OPND_TYPE(phis[p].args[j]) != TEMP) continue;
+                    int v = OPND_INT(phis[p].args[j]);
+                    if (pass == 0) use_first[v]++; else uses[fill[v]++] = -(p + 1);
+                }
+            }
+        }
+
+        if (pass == 0) {
+            for (int v = 0, start = 0; v <= num_vals; v++) {
+                int count = use_first[v];
+                use_first[v] = fill[v] = start;
+                start += count;
+            } uses = (int *)arena_alloc(&func_arena, (use_first[num_vals] + 1) * sizeof(int));
+        }
+    }
+
+    blk_exec[0] = 1;
+    blk_work[num_blk_work++] = 0;
+    while (num_blk_work > 0 || num_val_work > 0) {
+        if (num_blk_work > 0) {
+            // a block control was just found to reach
+            int b = blk_work[--num_blk_work];
+            for (int p = blk_phi[b]; p < blk_phi[b + 1]; p++) sccp_phi(p);
+            for (int i = cfg.block[b].first; i < cfg.block[b].end; i++) sccp_instr(i);
+
+            OpType last = ir.instr[cfg.block[b].end - 1].op;
+            if (last != OP_GOTO && last != OP_RETURN && !is_cond_branch(last)) sccp_edge(b, 0);
+            continue;
+        }
+
+        // a value that just changed
+        int v = val_work[--num_val_work];
+        for (int k = use_first[v]; k < use_first[v + 1]; k++) {
+            int u = uses[k];
+            if (u >= 0) {
+                if (blk_exec[instr_block[u]]) sccp_instr(u);
+            } else {
+                if (blk_exec[phis[-u - 1].block]) sccp_phi(-u - 1);
+            }
+        }
+    }
+
+    sccp_rewrite();
+}
+
+
+/*************** VALUE NUMBERING *****************/
+
+/*
+ * Global value numbering over the dominator tree: an expression computed
+ * in a block that a block dominates is reused there, as are copies, which
+ * leave their dest a name for their source.  The table of expressions is
+ * scoped: what a block adds is taken out when the walk leaves it.  Values
+ * are set once, so an expression is named by its op and operands.
+ */
+typedef struct {
+    int      op;
+    Operand  a, b;
+    int      val;
+    int      next;      // the entry under it in its bucket, -1 if none
+} GVNEntry;
+
+static GVNEntry *gvn_entries;
+static int       gvn_count;
+static int      *gvn_head;
+static int       gvn_mask;
+static Operand  *repl;      // what each value stands for now
+
+static unsigned int gvn_hash(int op, Operand a, Operand b) {
+    unsigned long long h = (unsigned long long)op * 0x9e3779b97f4a7c15ull;
+    h = (h ^ a) * 0xc2b2ae3d27d4eb4full;
+    h = (h ^ b) * 0x165667b19e3779f9ull;
+    return (unsigned int)(h >> 32) & gvn_mask;
+}
+
+static Operand gvn_operand(Operand op) {
+    while (OPND_TYPE(op) == TEMP && repl[OPND_INT(op)] != op) op = repl[OPND_INT(op)];
+    return op;
+}
+
+// the value of op a b, or -1 after adding it as val
+static int gvn_lookup(int op, Operand a, Operand b, int val) {
+    unsigned int h = gvn_hash(op, a, b);
+    for (int e = gvn_head[h]; e >= 0; e = gvn_entries[e].next) {
+        GVNEntry *entry = &gvn_entries[e];
+        if (entry->op == op && entry->a == a && entry->b == b) return entry->val;
+    }
+
+    GVNEntry *entry = &gvn_entries[gvn_count];
+    entry->op   = op;
+    entry->a    = a;
+    entry->b    = b;
+    entry->val  = val;
+    entry->next = gvn_head[h];
+    gvn_head[h] = gvn_count++;
+    return -1;
+}
+
+// a phi whose args are all one operand (or the phi itself) is that operand
+static void gvn_phi(Phi *phi) {
+    Operand same = NO_OPERAND;
+    Operand self = temp_operand(phi->dest);
+    for (int j = 0; j < cfg.block[phi->block].num_pred; j++) {
+        Operand arg = gvn_operand(phi->args[j]);
+        if (arg == NO_OPERAND || arg == self) continue;
+        if (same != NO_OPERAND && arg != same) return;
+        same = arg;
+    }
+
+    if (same == NO_OPERAND) return;
+    repl[phi->dest] = same;
+    phi->dest = -1;
+}
+
+static void gvn_block(int b) {
+    for (int p = blk_phi[b]; p < blk_phi[b + 1]; p++) {
+        if (phis[p].dest >= 0) gvn_phi(&phis[p]);
+    }
+
+    for (int i = cfg.block[b].first; i < cfg.block[b].end; i++) {
+        Instr *instr = &ir.instr[i];
+        instr->src1 = gvn_operand(instr->src1);
+        instr->src2 = gvn_operand(instr->src2);
+        if (OPND_TYPE(instr->dest) != TEMP) continue;
+
+        int dest = OPND_INT(instr->dest);
+        switch (instr->op) {
+            case OP_PLUS:
+            case OP_MINUS:
+            case OP_MUL:
+            case OP_DIV:
+            case OP_UNARY_MINUS:
+            {
+                // only expressions of values; a global may change
+                if (OPND_TYPE(instr->src1) == STPTR || OPND_TYPE(instr->src2) == STPTR) break;
+
+                // a + b is b + a
+                Operand a = instr->src1, c = instr->src2;
+                if ((instr->op == OP_PLUS || instr->op == OP_MUL) && a > c) {
+                    Operand swap = a;
+                    a = c;
+                    c = swap;
+                }
+
+                int val = gvn_lookup(instr->op, a, c, dest);
+                if (val >= 0) {
+                    repl[dest] = temp_operand(val);
+                    instr->op  = OP_NOP;
+                } break;
+            }
+            case OP_ASSG:
+                if (OPND_TYPE(instr->src1) == STPTR) break;
+                repl[dest] = instr->src1;
+                instr->op  = OP_NOP;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static void gvn() {
+    int n = cfg.count;
+
+    int size = 16;
+    while (size < 2 * (ir.count + 1)) size *= 2;
+    gvn_entries = (GVNEntry *)arena_alloc(&func_arena, (ir.count + 1) * sizeof(GVNEntry));
+    gvn_head    = (int *)arena_alloc(&func_arena, size * sizeof(int));
+    gvn_mask    = size - 1;
+    gvn_count   = 0;
+    for (int h = 0; h < size; h++) gvn_head[h] = -1;
+
+    repl = (Operand *)arena_alloc(&func_arena, (num_vals + 1) * sizeof(Operand));
+    for (int v = 0; v < num_vals; v++) repl[v] = temp_operand(v);
+
+    // the dominator tree, walked in preorder; a block on the stack is
+    // entered, its complement left
+    int *kid_first = (int *)arena_alloc(&func_arena, (n + 2) * sizeof(int));
+    int *kids      = (int *)arena_alloc(&func_arena, (n + 1) * sizeof(int));
+    int *fill      = (int *)arena_alloc(&func_arena, (n + 1) * sizeof(int));
+    for (int b = 1; b < n; b++) {
+        if (cfg.idom[b] >= 0) kid_first[cfg.idom[b]]++;
+    }
+    for (int b = 0, start = 0; b <= n; b++) {
+        int count = kid_first[b];
+        kid_first[b] = fill[b] = start;
+        start += count;
+    }
+    for (int b = 1; b < n; b++) {
+        if (cfg.idom[b] >= 0) kids[fill[cfg.idom[b]]++] = b;
+    }
+
+    int *top   = (int *)arena_alloc(&func_arena, (n + 1) * sizeof(int));
+    int *stack = (int *)arena_alloc(&func_arena, (2 * n + 1) * sizeof(int));
+    int  sp    = 0;
+    stack[sp++] = 0;
+    while (sp > 0) {
+        int b = stack[--sp];
+        if (b < 0) {
+            // take out what the block added, newest first
+            for (b = ~b; gvn_count > top[b]; gvn_count--) {
+                GVNEntry *entry = &gvn_entries[gvn_count - 1];
+                gvn_head[gvn_hash(entry->op, entry->a, entry->b)] = entry->next;
+            } continue;
+        }
+
+        top[b] = gvn_count;
+        stack[sp++] = ~b;
+        gvn_block(b);
+        for (int k = kid_first[b]; k < kid_first[b + 1]; k++) stack[sp++] = kids[k];
+    }
+
+    // the args of phis may come around a loop, from blocks seen later, and
+    // a phi left with one executable edge may stand for a value from a
+    // block that does not dominate it, so resolve every operand again
+    for (int i = 0; i < ir.count; i++) {
+        if (ir.instr[i].op == OP_NOP) continue;
+        ir.instr[i].src1 = gvn_operand(ir.instr[i].src1);
+        ir.instr[i].src2 = gvn_operand(ir.instr[i].src2);
+    }
+    for (int p = 0; p < num_phis; p++) {
+        if (phis[p].dest < 0) continue;
+        for (int j = 0; j < cfg.block[phis[p].block].num_pred; j++) {
+            phis[p].args[j] = gvn_operand(phis[p].args[j]);
+        }
+    }
+}
+
+
+/*************** DEAD CODE *****************/
+
+// drop the instrs and phis whose values are never read by anything that
+// has to stay: the values read by branches, calls, returns and stores to
+// globals, and what those are computed from
+static char *val_live;
+
+static void ssa_dce() {
+    val_live   = (char *)arena_alloc(&func_arena, num_vals + 1);
+    int *work  = (int *)arena_alloc(&func_arena, (num_vals + 1) * sizeof(int));
+    int  nwork = 0;
+
+    #define MARK(op) do {                                                    \
+        if (OPND_TYPE(op) == TEMP && !val_live[OPND_INT(op)]) {             \
+            val_live[OPND_INT(op)] = 1;                                      \
+            work[nwork++] = OPND_INT(op);                                    \
+        }                                                                    \
+    } while (0)
+
+    for (int i = 0; i < ir.count; i++) {
+        Instr *instr = &ir.instr[i];
+        if (instr->op == OP_NOP || (is_pure_def(instr->op) && OPND_TYPE(instr->dest) == TEMP)) continue;
+        MARK(instr->src1);
+        MARK(instr->src2);
+    }
+
+    while (nwork > 0) {
+        int def = val_def[work[--nwork]];
+        if (def == DEF_ENTRY) continue;
+        if (def >= 0) {
+            MARK(ir.instr[def].src1);
+            MARK(ir.instr[def].src2);
+        } else {
+            Phi *phi = &phis[-def - 1];
+            for (int j = 0; j < cfg.block[phi->block].num_pred; j++) MARK(phi->args[j]);
+        }
+    }
+    #undef MARK
+
+    for (int i = 0; i < ir.count; i++) {
+        Instr *instr = &ir.instr[i];
+        if (is_pure_def(instr->op) && OPND_TYPE(instr->dest) == TEMP && !val_live[OPND_INT(instr->dest)]) {
+            instr->op = OP_NOP;
+        }
+    }
+    for (int p = 0; p < num_phis; p++) {
+        if (phis[p].dest >= 0 && !val_live[phis[p].dest]) phis[p].dest = -1;
+    }
+}
+
+
+/*************** OUT OF SSA *****************/
+
+/*
+ * Each phi becomes a value of its own, set by a copy at the end of each
+ * pred and copied into the phi's dest at the top of its block (Sreedhar's
+ * first method), so no copy can clobber a value still needed on another
+ * edge.  Then the values are merged into classes, each held in one place:
+ * the two sides of a copy, and the versions of each variable, share a
+ * class wherever they don't interfere -- one is live where the other is
+ * set.  The class of a variable's versions lives in its slot, and what is
+ * left in a temp if it stays in one block, else in a new local.
+ */
+static Instr *code;
+static int    code_count;
+static int   *code_first, *code_end;    // block b is code[code_first[b] .. code_end[b])
+
+// add an instr to the end of the code coming out of SSA
+static void push_instr(OpType op, Operand src1, Operand dest) {
+    Instr *instr = &code[code_count++];
+    instr->op   = op;
+    instr->next = 0;
+    instr->src1 = src1;
+    instr->src2 = NO_OPERAND;
+    instr->dest = dest;
+}
+
+// the value of each phi once it is out of SSA, -1 if the phi is gone
+static int *phi_val;
+
+// the copies into the phis of block b's succs, on the edges that are taken
+static void push_phi_copies(int b) {
+    for (int k = 0; k < 2; k++) {
+        int s = cfg.block[b].succ[k];
+        if (s < 0 || !edge_exec[2 * b + k]) continue;
+        if (k == 1 && s == cfg.block[b].succ[0] && edge_exec[2 * b]) continue;
+
+        int j = 0;
+        while (cfg.block[s].pred[j] != b) j++;
+        for (int p = blk_phi[s]; p < blk_phi[s + 1]; p++) {
+            if (phi_val[p] >= 0) push_instr(OP_ASSG, phis[p].args[j], temp_operand(phi_val[p]));
+        }
+    }
+}
+
+// lay the code out again with the copies that replace the phis and the
+// loads of the variables on entry
+static void lower_phis() {
+    int n = cfg.count;
+    phi_val = (int *)arena_alloc(&func_arena, (num_phis + 1) * sizeof(int));
+    int size = ir.count + num_vars + 1;
+    for (int p = 0; p < num_phis; p++) {
+        phi_val[p] = phis[p].dest >= 0 ? new_val(phis[p].var, DEF_ENTRY) : -1;
+        if (phi_val[p] >= 0) size += 1 + cfg.block[phis[p].block].num_pred;
+    }
+
+    code       = (Instr *)arena_alloc(&func_arena, size * sizeof(Instr));
+    code_first = (int *)arena_alloc(&func_arena, (n + 1) * sizeof(int));
+    code_end   = (int *)arena_alloc(&func_arena, (n + 1) * sizeof(int));
+    code_count = 0;
+    for (int b = 0; b < n; b++) {
+        code_first[b] = code_count;
+        int copied = 0;
+        for (int i = cfg.block[b].first; i < cfg.block[b].end; i++) {
+            Instr *instr = &ir.instr[i];
+            if (instr->op == OP_NOP) continue;
+
+            // the copies that end the block go before its jump
+            if (i == cfg.block[b].end - 1 && ends_block(instr->op)) {
+                push_phi_copies(b);
+                copied = 1;
+            } code[code_count++] = *instr;
+
+            if (i > cfg.block[b].first) continue;
+            if (instr->op == OP_ENTER) {
+                for (int v = 0; v < num_vars; v++) {
+                    if (entry_val[v] >= 0 && val_live[entry_val[v]]) {
+                        push_instr(OP_ASSG, new_operand(STPTR, (void *)vars[v]), temp_operand(entry_val[v]));
+                    }
+                }
+            } else if (instr->op == OP_LABEL) {
+                for (int p = blk_phi[b]; p < blk_phi[b + 1]; p++) {
+                    if (phi_val[p] >= 0) push_instr(OP_ASSG, temp_operand(phi_val[p]), temp_operand(phis[p].dest));
+                }
+            }
+        }
+
+        if (!copied) push_phi_copies(b);
+        code_end[b] = code_count;
+    }
+}
+
+// the interference graph, between the values that might share a class:
+// the versions of variables and the values copied to or from each other
+static int *adj_first;
+static int *adj;
+
+// returns 0 if there would be too many edges
+static int find_interference() {
+    int n = cfg.count;
+    int words = BIT_WORDS(num_vals);
+
+    // what is live at the bottom of each block
+    Dataflow live;
+    if ((long long)n * words > SSA_MAX_WORDS || !df_init(&live, DF_BACKWARD, DF_UNION, num_vals)) return 0;
+    for (int b = 0; b < n; b++) {
+        BitWord *gen  = DF_SET(&live, gen, b);
+        BitWord *kill = DF_SET(&live, kill, b);
+        for (int i = code_end[b] - 1; i >= code_first[b]; i--) {
+            Instr *instr = &code[i];
+            if (is_pure_def(instr->op) && OPND_TYPE(instr->dest) == TEMP) {
+                BIT_SET(kill, OPND_INT(instr->dest));
+                BIT_CLEAR(gen, OPND_INT(instr->dest));
+            }
+            if (instr->op == OP_CALL) continue;
+            if (OPND_TYPE(instr->src1) == TEMP) BIT_SET(gen, OPND_INT(instr->src1));
+            if (OPND_TYPE(instr->src2) == TEMP) BIT_SET(gen, OPND_INT(instr->src2));
+        }
+    }
+    df_solve(&live);
+
+    BitWord *cand = (BitWord *)arena_alloc(&func_arena, (words + 1) * sizeof(BitWord));
+    for (int v = 0; v < num_vals; v++) {
+        if (val_var[v] >= 0) BIT_SET(cand, v);
+    }
+    for (int i = 0; i < code_count; i++) {
+        if (code[i].op == OP_ASSG && OPND_TYPE(code[i].dest) == TEMP && OPND_TYPE(code[i].src1) == TEMP) {
+            BIT_SET(cand, OPND_INT(code[i].dest));
+            BIT_SET(cand, OPND_INT(code[i].src1));
+        }
+    }
+
+    // each value interferes with the ones live where it is set, but for
+    // the source of a copy, which holds the same
+    int  cap   = 1024;
+    int  num   = 0;
+    int *pairs = (int *)arena_alloc(&func_arena, 2 * cap * sizeof(int));
+    BitWord *cur = (BitWord *)arena_alloc(&func_arena, (words + 1) * sizeof(BitWord));
+    for (int b = 0; b < n; b++) {
+        memcpy(cur, DF_SET(&live, out, b), words * sizeof(BitWord));
+        for (int i = code_end[b] - 1; i >= code_first[b]; i--) {
+            Instr *instr = &code[i];
+            if (is_pure_def(instr->op) && OPND_TYPE(instr->dest) == TEMP) {
+                int d    = OPND_INT(instr->dest);
+                int same = instr->op == OP_ASSG && OPND_TYPE(instr->src1) == TEMP ? OPND_INT(instr->src1) : -1;
+                BIT_CLEAR(cur, d);
+                if (BIT_TEST(cand, d)) {
+                    for (int w = 0; w < words; w++) {
+                        for (BitWord bits = cur[w] & cand[w]; bits; bits &= bits - 1) {
+                            int l = w * 64 + __builtin_ctzll(bits);
+                            if (l == same) continue;
+                            if (num == SSA_MAX_EDGES) return 0;
+                            if (num == cap) {
+                                int *more = (int *)arena_alloc(&func_arena, 4 * cap * sizeof(int));
+                                memcpy(more, pairs, 2 * cap * sizeof(int));
+                                pairs = more;
+                                cap *= 2;
+                            }
+                            pairs[2 * num]     = d;
+                            pairs[2 * num + 1] = l;
+                            num++;
+                        }
+                    }
+                }
+            }
+            if (instr->op == OP_CALL) continue;
+            if (OPND_TYPE(instr->src1) == TEMP) BIT_SET(cur, OPND_INT(instr->src1));
+            if (OPND_TYPE(instr->src2) == TEMP) BIT_SET(cur, OPND_INT(instr->src2));
+        }
+    }
+
+    // as a list of neighbors for each value
+    adj_first = (int *)arena_alloc(&func_arena, (num_vals + 2) * sizeof(int));
+    adj       = (int *)arena_alloc(&func_arena, (2 * num + 1) * sizeof(int));
+    int *fill = (int *)arena_alloc(&func_arena, (num_vals + 1) * sizeof(int));
+    for (int e = 0; e < 2 * num; e++) adj_first[pairs[e]]++;
+    for (int v = 0, start = 0; v <= num_vals; v++) {
+        int count = adj_first[v];
+        adj_first[v] = fill[v] = start;
+        start += count;
+    }
+    for (int e = 0; e < num; e++) {
+        adj[fill[pairs[2 * e]]++]     = pairs[2 * e + 1];
+        adj[fill[pairs[2 * e + 1]]++] = pairs[2 * e];
+    } return 1;
+}
+
+// the classes, as a union-find forest; each root keeps its members in a
+// list, the variable whose slot it wants, and the one it holds on entry
+static int *cls_parent;
+static int *cls_size;
+static int *cls_next, *cls_tail;
+static int *cls_var;
+static int *cls_entry;
+
+static int cls_find(int v) {
+    while (cls_parent[v] != v) v = cls_parent[v] = cls_parent[cls_parent[v]];
+    return v;
+}
+
+static int cls_interfere(int a, int b) {
+    if (cls_size[a] > cls_size[b]) {
+        int swap = a;
+        a = b;
+        b = swap;
+    }
+
+    for (int m = a; m >= 0; m = cls_next[m]) {
+        for (int k = adj_first[m]; k < adj_first[m + 1]; k++) {
+            if (cls_find(adj[k]) == b) return 1;
+        }
+    } return 0;
+}
+
+// merge the classes of a and b if they don't interfere
+static void cls_merge(int a, int b) {
+    a = cls_find(a);
+    b = cls_find(b);
+    if (a == b || cls_interfere(a, b)) return;
+    if (cls_size[a] < cls_size[b]) {
+        int swap = a;
+        a = b;
+        b = swap;
+    }
+
+    cls_parent[b] = a;
+    cls_size[a] += cls_size[b];
+    cls_next[cls_tail[a]] = b;
+    cls_tail[a] = cls_tail[b];
+
+    // a variable's version on entry is loaded into the class; it must
+    // not be put in another variable's slot
+    if (cls_entry[a] < 0) cls_entry[a] = cls_entry[b];
+    if (cls_entry[a] >= 0) {
+        cls_var[a] = cls_entry[a];
+    } else if (cls_var[a] < 0) {
+        cls_var[a] = cls_var[b];
+    }
+}
+
+// a local for a class that can't have a variable's slot or a temp
+static Operand new_local(int var) {
+    static int count = 0;
+    char *name = arena_sprintf(&func_arena, "%s.%d", var >= 0 ? vars[var]->lexeme : "ssa", ++count);
+    symtab_entry *entry = add_entry(name, VAR);
+    entry->fp_offset = -4 * ++frame_locals;
+    return new_operand(STPTR, (void *)entry);
+}
+
+// take the code out of SSA into ir
+// returns 0 if the function is too large to
+static int from_ssa() {
+    lower_phis();
+    if (!find_interference()) return 0;
+
+    cls_parent = (int *)arena_alloc(&func_arena, (num_vals + 1) * sizeof(int));
+    cls_size   = (int *)arena_alloc(&func_arena, (num_vals + 1) * sizeof(int));
+    cls_next   = (int *)arena_alloc(&func_arena, (num_vals + 1) * sizeof(int));
+    cls_tail   = (int *)arena_alloc(&func_arena, (num_vals + 1) * sizeof(int));
+    cls_var    = (int *)arena_alloc(&func_arena, (num_vals + 1) * sizeof(int));
+    cls_entry  = (int *)arena_alloc(&func_arena, (num_vals + 1) * sizeof(int));
+    for (int v = 0; v < num_vals; v++) {
+        cls_parent[v] = cls_tail[v] = v;
+        cls_size[v]  = 1;
+        cls_next[v]  = -1;
+        cls_var[v]   = val_var[v];
+        cls_entry[v] = val_def[v] == DEF_ENTRY && val_var[v] >= 0 && entry_val[val_var[v]] == v ? val_var[v] : -1;
+    }
+
+    // the two sides of each copy
+    for (int i = 0; i < code_count; i++) {
+        if (code[i].op == OP_ASSG && OPND_TYPE(code[i].dest) == TEMP && OPND_TYPE(code[i].src1) == TEMP) {
+            cls_merge(OPND_INT(code[i].dest), OPND_INT(code[i].src1));
+        }
+    }
+
+    // where each value is set and read: a value set once and only read in
+    // its block can stay a temp
+    int  *def_block = (int *)arena_alloc(&func_arena, (num_vals + 1) * sizeof(int));
+    char *in_block  = (char *)arena_alloc(&func_arena, num_vals + 1);
+    char *seen      = (char *)arena_alloc(&func_arena, num_vals + 1);
+    for (int v = 0; v < num_vals; v++) def_block[v] = -1;
+    for (int b = 0; b < cfg.count; b++) {
+        for (int i = code_first[b]; i < code_end[b]; i++) {
+            if (!is_pure_def(code[i].op) || OPND_TYPE(code[i].dest) != TEMP) continue;
+            int d = OPND_INT(code[i].dest);
+            in_block[d] = def_block[d] < 0;
+            def_block[d] = b;
+            seen[d] = 1;
+        }
+    }
+    for (int b = 0; b < cfg.count; b++) {
+        for (int i = code_first[b]; i < code_end[b]; i++) {
+            Operand ops[2] = { code[i].src1, code[i].src2 };
+            for (int k = 0; k < 2; k++) {
+                if (OPND_TYPE(ops[k]) != TEMP || code[i].op == OP_CALL) continue;
+                int v = OPND_INT(ops[k]);
+                if (def_block[v] != b) in_block[v] = 0;
+                seen[v] = 1;
+            }
+        }
+    }
+
+    // the versions of each variable, into the class that holds it on entry
+    // (or the first) where they don't interfere
+    int *home = (int *)arena_alloc(&func_arena, (num_vars + 1) * sizeof(int));
+    for (int x = 0; x < num_vars; x++) {
+        home[x] = entry_val[x] >= 0 && seen[entry_val[x]] ? entry_val[x] : -1;
+    }
+    for (int v = 0; v < num_vals; v++) {
+        int x = cls_var[cls_find(v)];
+        if (!seen[v] || x < 0) continue;
+        if (home[x] < 0) {
+            home[x] = v;
+        } else if (cls_var[cls_find(home[x])] == x) {
+            cls_merge(home[x], v);
+        }
+    }
+
+    // where each class lives
+    Operand *place = (Operand *)arena_alloc(&func_arena, (num_vals + 1) * sizeof(Operand));
+    for (int v = 0; v < num_vals; v++) {
+        int root = cls_find(v);
+        if (!seen[v] || place[root] != NO_OPERAND) continue;
+
+        int x = cls_var[root];
+        if (x >= 0 && home[x] >= 0 && cls_find(home[x]) == root) {
+            place[root] = new_operand(STPTR, (void *)vars[x]);
+        } else if (cls_size[root] == 1 && in_block[root]) {
+            place[root] = temp_operand(root);
+        } else {
+            place[root] = new_local(x);
+        }
+    }
+
+    // and into ir, dropping the copies that are left copying a place into itself
+    if (ir.cap < code_count) {
+        ir.cap = code_count;
+        ir.instr = (Instr *)realloc(ir.instr, ir.cap * sizeof(Instr));
+    }
+
+    ir.count = 0;
+    for (int i = 0; i < code_count; i++) {
+        Instr *instr = &code[i];
+        Operand *ops[3] = { &instr->src1, &instr->src2, &instr->dest };
+        for (int k = 0; k < 3; k++) {
+            if (OPND_TYPE(*ops[k]) == TEMP) *ops[k] = place[cls_find(OPND_INT(*ops[k]))];
+        }
+        if (instr->op == OP_ASSG && instr->src1 == instr->dest) continue;
+        ir.instr[ir.count++] = *instr;
+    }
+
+    tmp_num = num_vals;
+    return 1;
+}
@@ -0,0 +1,15 @@
+/*
+ * File: ssa.h
+ * Author: Maria Fay Garcia
+ * Purpose: To outline the SSA tier of the optimizer, run over the
+ *          three address code of a function at -O2
+ */
+#ifndef __SSA_H__
+#define __SSA_H__
+
+#include "cfg.h"
+
+// function stubs
+void     ssa_optimize    (                  );
+
+#endif  /* __SSA_H__ */
@@ -1,62 +1,66 @@
 // for performing semantic checking
 #include "symtab.h"
+#include "scanner.h"
+#include "arena.h"
 
-symtab_entry *symtab_hds[2];
+ScopeTable symtabs[2];
 char *types[2] = {"GLOBAL", "LOCAL"};
 char *err_types[2] = {"SYNTAX", "SEMANTIC"};
 
-// perform semantic checking by traversing the AST for the func
-void perform_semantic_checking(ASTNode *node) {
+// perform semantic checking on the function whose FUNC_DEF node is func
+// the nodes of a function sit after it in the pool, and the named ones
+// are in source order, so a linear walk finds errors in the same order
+// as a preorder traversal would
+void perform_semantic_checking(NodeId func) {
+    if (!chk_decl_flag) return;
 
-    // base case
-    if (!node) return;
+    for (NodeId id = func; id < ast_count; id++) {
+        ASTNode *node = AST(id);
+        if (node->type != FUNC_DEF && node->type != FUNC_CALL &&
+            node->type != ASSG && node->type != IDENTIFIER) continue;
 
-    // preorder traversal
-    if (chk_decl_flag) {
-
-        int line_num = node->line_num;
-        int col_num  = node->col_num;
-        char *lexeme = node->lexeme;
+        int tok      = node->tok;
+        char *lexeme = ast_syms[node->sym].lexeme;
 
         int num_args_passed;
-        symtab_entry *entry = node->symtab_entry;
+        symtab_entry *entry = ast_syms[node->sym].entry;
         switch (node->type) {
             case FUNC_DEF:
-                // count num_args by recursing through opt_formals
+                // count num_args by walking opt_formals
                 // child0 is where opt_formals are stored
-                node->symtab_entry->num_args = count_num_args(node->child0);
+                entry->num_args = count_num_args(node->child0);
                 break;
             case FUNC_CALL:
                 if (!entry) {
                     // func does not exist
-                    throw_error(line_num, col_num, "Use before declaration of", FUNC, lexeme);
+                    throw_error(tok, "Use before declaration of", FUNC, lexeme);
                 } else if (entry->type == VAR) {
                     // an int var tried to act as a function call
-                    throw_error(line_num, col_num, "Callee is not a", FUNC, lexeme);
+                    throw_error(tok, "Callee is not a", FUNC, lexeme);
                 }
 
                 // verify num_args passed is correct
                 // child0 is where the opt_expr_list is stored
                 num_args_passed = count_num_args_passed(node->child0);
-                if (num_args_passed != node->symtab_entry->num_args) {
-                    throw_error(line_num, col_num, "Incorrect no. of arguments in call for", FUNC, lexeme);
+                if (num_args_passed != entry->num_args) {
+                    throw_error(tok, "Incorrect no. of arguments in call for", FUNC, lexeme);
                 }
 
                 break;
             case ASSG:
                 if (!entry) {
                     // variable does not exist
-                    throw_error(line_num, col_num, "Use before declaration of", VAR, lexeme);
+                    throw_error(tok, "Use before declaration of", VAR, lexeme);
                 } else if (entry->type == FUNC) {
                     // trying to assign to a function
-                    throw_error(line_num, col_num, "Assignment LHS is a", FUNC, lexeme);
+                    throw_error(tok, "Assignment LHS is a", FUNC, lexeme);
                 } break;
             case IDENTIFIER:
                 // if symtab_entry is null, error
                 if (!entry) {
-                    throw_error(line_num, col_num, "Use before declaration of", VAR, lexeme);
+                    throw_error(tok, "Use before declaration of", VAR, lexeme);
                 } else if (entry->type == FUNC) {
-                    throw_error(line_num, col_num, "Using a function as a variable!", FUNC, lexeme);
+                    throw_error(tok, "Using a function as a variable!", FUNC, lexeme);
 
                 }
 
@@ -64,39 +68,36 @@ void perform_semantic_checking(ASTNode *node) {
             default:
                 break;
         }
-
-        // traverse the children
-        perform_semantic_checking(node->child0);
-        perform_semantic_checking(node->child1);
-        perform_semantic_checking(node->child2);
     }
 }
 
-// count the number of args in a func defn by recursing through formals
-int count_num_args(ASTNode *node) {
-    if (!node) return 0;
-    else return 1 + count_num_args(node->child0);
+// count the number of args in a func defn by walking the formals
+int count_num_args(NodeId node) {
+    int n = 0;
+    for (; node; node = AST(node)->child0) n++;
+    return n;
 }
 
-// count the number of args passed to func call by recursing through exprs
-int count_num_args_passed(ASTNode *node) {
-    if (!node) return 0;
-    else return 1 + count_num_args_passed(node->child1);
-
+// count the number of args passed to func call by walking the exprs
+int count_num_args_passed(NodeId node) {
+    int n = 0;
+    for (; node; node = AST(node)->child1) n++;
+    return n;
 }
 
 
 // adds a declaration to the symbol table or throws an error if necessary
-symtab_entry* add_decl(char *lexeme, Type type) {
+// name must be interned
+symtab_entry* add_decl(char *name, Type type) {
     if (chk_decl_flag) {
-        symtab_entry *entry = symtab_lookup(lexeme);
+        symtab_entry *entry = symtab_lookup(name);
 
         if (entry && entry->scope == cur_scope) {
             // double declaration, throw error
-            throw_error(line_num, col_num, "Double declaration of", type, lexeme);
+            throw_error(tok_idx, "Double declaration of", type, name);
         } else {
             // create a new entry in the symbol table -- add it to the desired scope
-            symtab_entry *new_entry = add_entry(lexeme, type);
+            symtab_entry *new_entry = add_entry(name, type);
 
             // return a pointer to the new entry
             return new_entry;
@@ -104,9 +105,36 @@ symtab_entry* add_decl(char *lexeme, Type type) {
     } return NULL;
 }
 
+// names are interned, so the pointer itself is hashed
+static unsigned int hash_ptr(char *name) {
+    unsigned long long h = (unsigned long long)(unsigned long)name * 0x9e3779b97f4a7c15ull;
+    return (unsigned int)(h >> 32);
+}
+
+// the slot that holds name, or the empty slot where it would go
+static int find_slot(ScopeTable *scope, char *name) {
+    int mask = scope->num_slots - 1;
+    int i = hash_ptr(name) & mask;
+    while (scope->slots[i] && scope->slots[i]->lexeme != name) i = (i + 1) & mask;
+    return i;
+}
+
+// double the index of a scope and re-insert every entry
+static void grow_scope(ScopeTable *scope) {
+    free(scope->slots);
+    scope->num_slots = scope->num_slots ? 2 * scope->num_slots : 64;
+    scope->slots = (symtab_entry **)calloc(scope->num_slots, sizeof(symtab_entry *));
+
+    for (symtab_entry *cur = scope->head; cur; cur = cur->next) {
+        scope->slots[find_slot(scope, cur->lexeme)] = cur;
+    }
+}
+
 // create a new symtab entry, add it to the desired scope, and return it
 symtab_entry* add_entry(char *lexeme, Type type) {
-    symtab_entry* new_entry = (symtab_entry *)calloc(1, sizeof(symtab_entry));
+    // locals are dropped with the rest of the function
+    Arena *arena = cur_scope == LOCAL ? &func_arena : &glob_arena;
+    symtab_entry* new_entry = (symtab_entry *)arena_alloc(arena, sizeof(symtab_entry));
 
     new_entry->lexeme = lexeme;
     new_entry->type = type;
@@ -115,43 +143,76 @@ symtab_entry* add_entry(char *lexeme, Type type) {
     new_entry->scope = cur_scope;
     // next should be NULL
 
-    // add entry to the desired scope
-    symtab_entry *prev, *cur;
-    prev = NULL;
-    cur = symtab_hds[cur_scope];
-    while (cur) {
-        prev = cur;
-        cur = cur->next;
-    }
+    // add entry to the desired scope's index (load factor under 1/2)
+    ScopeTable *scope = &symtabs[cur_scope];
+    if (2 * (scope->num_entries + 1) > scope->num_slots) grow_scope(scope);
+    scope->slots[find_slot(scope, lexeme)] = new_entry;
+    scope->num_entries++;
 
-    if (prev) {
-        prev->next = new_entry;
+    // and to the end of its list
+    if (scope->tail) {
+        scope->tail->next = new_entry;
     } else {
-        symtab_hds[cur_scope] = new_entry;
+        scope->head = new_entry;
+    } scope->tail = new_entry;
+
+    // locals get the next slot below $fp, see mark_param for params
+    if (cur_scope == LOCAL && type == VAR) {
+        new_entry->fp_offset = -4 * ++scope->num_locals;
     }
 
     return new_entry;
 }
 
-// return most deeply nested instance of lexeme
-symtab_entry *symtab_lookup(char *lexeme) {
-    symtab_entry *to_return = scope_lookup(lexeme, LOCAL);
-    if (!to_return) to_return = scope_lookup(lexeme, GLOBAL);
+// turn the local just added into the next parameter
+// must be called right after its add_decl
+void mark_param(symtab_entry *entry) {
+    ScopeTable *scope = &symtabs[entry->scope];
+    entry->is_param = 1;
+    scope->num_locals--;
+    entry->fp_offset = 8 + 4 * scope->num_params++;
+}
+
+// empty a scope, keeping its index for the next function
+void clear_scope(Scope s) {
+    ScopeTable *scope = &symtabs[s];
+
+    // only the slots that are in use need to be cleared
+    // (look for the entry itself, earlier slots in its chain may be empty by now)
+    int mask = scope->num_slots - 1;
+    for (symtab_entry *cur = scope->head; cur; cur = cur->next) {
+        int i = hash_ptr(cur->lexeme) & mask;
+        while (scope->slots[i] != cur) i = (i + 1) & mask;
+        scope->slots[i] = NULL;
+    }
+
+    scope->head = scope->tail = NULL;
+    scope->num_entries = 0;
+    scope->num_locals  = 0;
+    scope->num_params  = 0;
+}
+
+// return most deeply nested instance of name
+symtab_entry *symtab_lookup(char *name) {
+    symtab_entry *to_return = scope_lookup(name, LOCAL);
+    if (!to_return) to_return = scope_lookup(name, GLOBAL);
     return to_return;
 }
 
 // perform a lookup for a particular scope in the symbol table
-symtab_entry* scope_lookup(char *lexeme, Scope scope) {
-    symtab_entry *cur = symtab_hds[scope];
-    if (!cur) return NULL;
-    while (cur) {
-        if (strcmp(lexeme, cur->lexeme) == 0) return cur;
-        cur = cur->next;
-    } return NULL;
+// names are interned, so equal names are the same pointer
+symtab_entry* scope_lookup(char *name, Scope scope) {
+    ScopeTable *table = &symtabs[scope];
+    if (!table->num_entries) return NULL;
+    return table->slots[find_slot(table, name)];
 }
 
 // print an err msg to stderr and exit the program
-void throw_error(int line_num, int col_num, char *err_msg, Type type, char *lexeme) {
+// tok is the index of the token the scanner was on when the error was found
+void throw_error(int tok, char *err_msg, Type type, char *lexeme) {
+    int line_num, col_num;
+    tok_position(tok, &line_num, &col_num);
+
     fprintf(stderr,
             "SEMANTIC ERROR IN LINE %d,%d: %s %s [lexeme: %s]\n",
             line_num,
@@ -168,7 +229,7 @@ void dump_symtab() {
 
     printf("--------- GLOBAL SCOPE ----------\n");
 
-    symtab_entry *cur = symtab_hds[GLOBAL];
+    symtab_entry *cur = symtabs[GLOBAL].head;
     while (cur) {
         printf("-------------\n%s\n%s\n%d\n%s\n------------\n",
                 cur->lexeme,
@@ -180,7 +241,7 @@ void dump_symtab() {
 
     printf("--------- LOCAL SCOPE -----------\n");
 
-    cur = symtab_hds[LOCAL];
+    cur = symtabs[LOCAL].head;
     while (cur) {
         printf("-------------\n%s\n%s\nis_param = %d\nnum_args = %d\n%s\n------------\n",
                 cur->lexeme,
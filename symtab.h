@@ -36,34 +36,54 @@ typedef struct symtab_entry {
            // for code gen
            int         fp_offset;
            int          is_param;
+           int               var; // its number among the variables of a function,
+           int          var_func; // valid while var_func is the optimizer's func_num
+  unsigned int          clobbers; // for a function compiled and println, the registers a call to it may change
+           int    clobbers_known;
+           int        is_runtime; // hand written in the runtime, so reads and assigns no globals
            // params +8 from fp
            // locals -4 from fp
 } symtab_entry;
 
+// one scope: the entries in the order they were added, plus an open
+// addressing index on the (interned) name
+typedef struct {
+           symtab_entry    *head;
+           symtab_entry    *tail;
+           symtab_entry  **slots;
+           int         num_slots;   // a power of two
+           int       num_entries;
+
+           // kept up to date as entries are added, for code gen
+           int        num_locals;   // VARs that are not params
+           int        num_params;
+} ScopeTable;
+
 #include "ast.h"
 
 // function stubs
-void          perform_semantic_checking(ASTNode *node   );
-int           count_num_args           (ASTNode *node   );
-int           count_num_args_passed    (ASTNode *node   );
-symtab_entry* add_decl                 (char    *lexeme  ,
+void          perform_semantic_checking(NodeId   func   );
+int           count_num_args           (NodeId   node   );
+int           count_num_args_passed    (NodeId   node   );
+symtab_entry* add_decl                 (char    *name    ,
                                         Type     type   );
 symtab_entry* add_entry                (char    *lexeme  ,
                                         Type     type   );
-symtab_entry* symtab_lookup            (char    *lexeme );
-symtab_entry* scope_lookup             (char    *lexeme  ,
+symtab_entry* symtab_lookup            (char    *name   );
+symtab_entry* scope_lookup             (char    *name    ,
                                         Scope    scope  );
-void          throw_error              (int      line_num,
-                                        int      col_num ,
+void          mark_param               (symtab_entry *entry);
+void          clear_scope              (Scope    scope  );
+void          throw_error              (int      tok     ,
                                         char    *err_msg , 
                                         Type     type    ,
                                         char    *lexeme );
 void dump_symtab();
 
 // globals
-extern int        line_num;
-extern int         col_num;
+extern int         tok_idx;
 extern int   chk_decl_flag;
 extern Scope     cur_scope;
+extern ScopeTable symtabs[2];
 
 #endif  /* __SYMTAB_H__ */
@@ -19,6 +19,11 @@ def check_error_output(actual_output, expected_output):
     actual_line = actual_match.group(1)
     expected_line = expected_match.group(1)
     
+    actual_lexeme = re.search(r'\[lexeme = (.*)\]', actual_output)
+    expected_lexeme = re.search(r'\[lexeme = (.*)\]', expected_output)
+    if actual_lexeme and expected_lexeme and actual_lexeme.group(1) != expected_lexeme.group(1):
+        return False, f"Error lexemes don't match: expected [{expected_lexeme.group(1)}], got [{actual_lexeme.group(1)}]"
+
     if actual_line == expected_line:
         return True, f"Error line numbers match: {actual_line}"
     else:
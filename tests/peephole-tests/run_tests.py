@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+
+import os
+import sys
+import subprocess
+import difflib
+import re
+
+# each test is named for the rule of peep.rules it must make fire, and
+# starts with the flags to compile it with, as in /* flags: -O1 */
+
+def rule_count(stats, rule):
+    match = re.search(rf'^{re.escape(rule)}\s+(\d+)\s*$', stats, re.MULTILINE)
+    return int(match.group(1)) if match else None
+
+def main():
+    base_dir = os.path.dirname(os.path.abspath(__file__))
+    tests_dir = os.path.join(base_dir, "tests")
+    expected_dir = os.path.join(base_dir, "expected-outputs")
+    sim_path = os.path.join(base_dir, "..", "runtime-tests", "mips_sim.py")
+
+    if not os.path.isdir(tests_dir):
+        print(f"Error: {tests_dir} directory not found")
+        sys.exit(1)
+
+    if not os.path.isdir(expected_dir):
+        print(f"Error: {expected_dir} directory not found")
+        sys.exit(1)
+
+    compile_path = "./compile"
+    if not os.path.isfile(compile_path) or not os.access(compile_path, os.X_OK):
+        print("Error: 'compile' executable not found or not executable")
+        sys.exit(1)
+
+    total = 0
+    passed = 0
+    failed = 0
+
+    print("===== Peephole Test Results =====")
+
+    for filename in sorted(os.listdir(tests_dir)):
+        test_file = os.path.join(tests_dir, filename)
+        if not os.path.isfile(test_file):
+            continue
+
+        expected_file = os.path.join(expected_dir, f"{filename}-out")
+        if not os.path.isfile(expected_file):
+            print(f"Warning: Expected output file not found for {filename}, skipping test")
+            continue
+
+        total += 1
+        try:
+            with open(test_file, 'r') as f:
+                match = re.match(r'/\*\s*flags:(.*?)\*/', f.readline())
+            flags = match.group(1).strip() if match else ""
+
+            with open(expected_file, 'r') as f:
+                expected_output = f.read()
+
+            result = subprocess.run(
+                f"{compile_path} --chk_decl --gen_code --pass_stats {flags} < {test_file}",
+                shell=True,
+                capture_output=True,
+                text=True,
+                check=False
+            )
+            if result.returncode != 0:
+                print(f"\n[FAIL] {filename}")
+                print("  Compile failed:")
+                print(f"  {result.stderr}")
+                failed += 1
+                continue
+
+            fired = rule_count(result.stderr, filename)
+            if not fired:
+                print(f"\n[FAIL] {filename}")
+                print(f"  The rule did not fire under {flags or 'no flags'}")
+                failed += 1
+                continue
+
+            run = subprocess.run(
+                [sys.executable, sim_path, "/dev/stdin"],
+                input=result.stdout,
+                capture_output=True,
+                text=True,
+                check=False
+            )
+            actual_output = run.stdout
+
+            if run.returncode == 0 and actual_output == expected_output:
+                passed += 1
+            else:
+                print(f"\n[FAIL] {filename}")
+                if run.stderr:
+                    print(f"  {run.stderr}")
+                print("Differences found:")
+                diff = difflib.unified_diff(
+                    actual_output.splitlines(),
+                    expected_output.splitlines(),
+                    fromfile='Output',
+                    tofile='Expected',
+                    lineterm=''
+                )
+                for line in diff:
+                    print(f"  {line}")
+                failed += 1
+
+        except Exception as e:
+            print(f"\n[ERROR] {filename}: {str(e)}")
+            failed += 1
+
+    print("\n===== Summary =====")
+    print(f"Total tests: {total}")
+    print(f"Passed:      {passed}")
+    print(f"Failed:      {failed}")
+
+    if failed == 0:
+        print("All tests passed!")
+        sys.exit(0)
+    else:
+        print("Some tests failed!")
+        sys.exit(1)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,222 @@
+#!/usr/bin/env python3
+
+# A small simulator for the mips code the compiler emits, enough to run the
+# runtime tests without spim.  It prints what the program prints and, if
+# the program traps, a last line "trap: <why>" as spim would stop there.
+# Like spim, add, addi, sub and neg trap on overflow and div traps on a
+# zero divisor, while mul does not trap and INT_MIN / -1 is INT_MIN.
+
+import re
+import sys
+
+REG_NAMES = ['zero', 'at', 'v0', 'v1', 'a0', 'a1', 'a2', 'a3',
+             't0', 't1', 't2', 't3', 't4', 't5', 't6', 't7',
+             's0', 's1', 's2', 's3', 's4', 's5', 's6', 's7',
+             't8', 't9', 'k0', 'k1', 'gp', 'sp', 'fp', 'ra']
+REGS = {'$' + name: k for k, name in enumerate(REG_NAMES)}
+REGS.update({'$%d' % k: k for k in range(32)})
+
+STEP_LIMIT = 50000000
+
+class Trap(Exception):
+    pass
+
+def s32(x):
+    x &= 0xffffffff
+    return x - (1 << 32) if x & 0x80000000 else x
+
+def checked(x):
+    if s32(x) != x:
+        raise Trap("arithmetic overflow")
+    return x
+
+class Machine:
+    def __init__(self, text):
+        self.mem = {}
+        self.labels = {}
+        self.code = []
+        self.out = []
+
+        data = 0x10010000
+        in_data = False
+        for line in text.split('\n'):
+            line = line.split('#')[0].strip()
+            while True:
+                m = re.match(r'^([A-Za-z_]\w*)\s*:\s*(.*)$', line)
+                if not m:
+                    break
+                self.labels[m.group(1)] = data if in_data else len(self.code)
+                line = m.group(2).strip()
+            if not line:
+                continue
+
+            if line.startswith('.'):
+                parts = line.split(None, 1)
+                if parts[0] == '.data':
+                    in_data = True
+                elif parts[0] == '.text':
+                    in_data = False
+                elif parts[0] == '.align':
+                    align = 1 << int(parts[1])
+                    data = (data + align - 1) // align * align
+                elif parts[0] == '.space':
+                    data += int(parts[1])
+                elif parts[0] == '.word':
+                    for word in parts[1].split(','):
+                        self.mem[data] = int(word)
+                        data += 4
+                elif parts[0] == '.asciiz':
+                    for ch in parts[1].strip()[1:-1].encode().decode('unicode_escape') + '\0':
+                        self.mem[('byte', data)] = ord(ch)
+                        data += 1
+                continue
+
+            m = re.match(r'^(\S+)\s*(.*)$', line)
+            args = [a.strip() for a in m.group(2).split(',')] if m.group(2) else []
+            self.code.append((m.group(1), args, line))
+
+    def reg(self, name):
+        if name not in REGS:
+            raise Exception("bad register " + name)
+        return REGS[name]
+
+    def val(self, opnd):
+        if opnd.startswith('$'):
+            return self.r[self.reg(opnd)]
+        return s32(int(opnd, 0))
+
+    def addr(self, opnd):
+        m = re.match(r'^(-?\d*)\((\$\w+)\)$', opnd)
+        if m:
+            return s32(self.r[self.reg(m.group(2))] + int(m.group(1) or 0))
+        return self.labels[opnd]
+
+    def set(self, name, value):
+        k = self.reg(name)
+        if k:
+            self.r[k] = s32(value)
+
+    def run(self):
+        r = self.r = [0] * 32
+        r[REGS['$sp']] = 0x7ffffffc
+        r[REGS['$ra']] = -1
+        pc = self.labels['main']
+
+        branch = {
+            'beq': lambda x, y: x == y, 'bne': lambda x, y: x != y,
+            'blt': lambda x, y: x < y,  'ble': lambda x, y: x <= y,
+            'bgt': lambda x, y: x > y,  'bge': lambda x, y: x >= y,
+        }
+        branch_zero = {
+            'beqz': lambda x: x == 0, 'bnez': lambda x: x != 0,
+            'bltz': lambda x: x < 0,  'blez': lambda x: x <= 0,
+            'bgtz': lambda x: x > 0,  'bgez': lambda x: x >= 0,
+        }
+        compare = {
+            'slt': lambda x, y: x < y,   'slti': lambda x, y: x < y,
+            'seq': lambda x, y: x == y,  'sne': lambda x, y: x != y,
+            'sltu': lambda x, y: x & 0xffffffff < y & 0xffffffff,
+            'sltiu': lambda x, y: x & 0xffffffff < y & 0xffffffff,
+        }
+
+        for step in range(STEP_LIMIT):
+            if pc == -1:
+                return
+            op, a, line = self.code[pc]
+            pc += 1
+
+            if op == 'la':
+                self.set(a[0], self.addr(a[1]))
+            elif op == 'li':
+                self.set(a[0], int(a[1], 0))
+            elif op == 'lui':
+                self.set(a[0], int(a[1], 0) << 16)
+            elif op == 'move':
+                self.set(a[0], self.val(a[1]))
+            elif op == 'lw':
+                self.set(a[0], self.mem.get(self.addr(a[1]), 0))
+            elif op == 'sw':
+                self.mem[self.addr(a[1])] = self.val(a[0])
+            elif op in ('add', 'addi'):
+                self.set(a[0], checked(self.val(a[1]) + self.val(a[2])))
+            elif op in ('addu', 'addiu'):
+                self.set(a[0], self.val(a[1]) + self.val(a[2]))
+            elif op == 'sub':
+                self.set(a[0], checked(self.val(a[1]) - self.val(a[2])))
+            elif op == 'subu':
+                self.set(a[0], self.val(a[1]) - self.val(a[2]))
+            elif op == 'neg':
+                self.set(a[0], checked(-self.val(a[1])))
+            elif op == 'negu':
+                self.set(a[0], -self.val(a[1]))
+            elif op == 'mul':
+                self.set(a[0], self.val(a[1]) * self.val(a[2]))
+            elif op in ('div', 'rem'):
+                x, y = self.val(a[1]), self.val(a[2])
+                if y == 0:
+                    raise Trap("division by zero")
+                q = abs(x) // abs(y)
+                if (x < 0) != (y < 0):
+                    q = -q
+                self.set(a[0], q if op == 'div' else x - q * y)
+            elif op == 'sll':
+                self.set(a[0], self.val(a[1]) << int(a[2]))
+            elif op == 'sra':
+                self.set(a[0], self.val(a[1]) >> int(a[2]))
+            elif op == 'srl':
+                self.set(a[0], (self.val(a[1]) & 0xffffffff) >> int(a[2]))
+            elif op in ('and', 'andi'):
+                self.set(a[0], self.val(a[1]) & self.val(a[2]))
+            elif op in ('or', 'ori'):
+                self.set(a[0], self.val(a[1]) | self.val(a[2]))
+            elif op in ('xor', 'xori'):
+                self.set(a[0], self.val(a[1]) ^ self.val(a[2]))
+            elif op in compare:
+                self.set(a[0], int(compare[op](self.val(a[1]), self.val(a[2]))))
+            elif op in ('j', 'b'):
+                pc = self.labels[a[0]]
+            elif op == 'jal':
+                r[REGS['$ra']] = pc
+                pc = self.labels[a[0]]
+            elif op == 'jr':
+                pc = self.val(a[0])
+            elif op in branch:
+                if branch[op](self.val(a[0]), self.val(a[1])):
+                    pc = self.labels[a[2]]
+            elif op in branch_zero:
+                if branch_zero[op](self.val(a[0])):
+                    pc = self.labels[a[1]]
+            elif op == 'nop':
+                pass
+            elif op == 'syscall':
+                service = r[REGS['$v0']]
+                if service == 1:
+                    self.out.append(str(r[REGS['$a0']]))
+                elif service == 4:
+                    p = r[REGS['$a0']]
+                    while self.mem.get(('byte', p), 0):
+                        self.out.append(chr(self.mem[('byte', p)]))
+                        p += 1
+                elif service == 10:
+                    return
+                else:
+                    raise Exception("unknown syscall %d" % service)
+            else:
+                raise Exception("unknown instruction: " + line)
+        raise Exception("step limit reached")
+
+def main():
+    if len(sys.argv) != 2:
+        print("Usage: ./mips_sim.py file.s")
+        sys.exit(1)
+
+    with open(sys.argv[1]) as f:
+        machine = Machine(f.read())
+    try:
+        machine.run()
+    except Trap as e:
+        machine.out.append(f"trap: {e}\n")
+    sys.stdout.write(''.join(machine.out))
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+
+import os
+import sys
+import subprocess
+import difflib
+import re
+
+# each program is compiled under every one of these, and must print the
+# same thing under all of them
+FLAG_SETS = [
+    "-O0",
+    "-O1",
+    "-O2",
+    "-Os",
+    "--disable=regalloc",
+    "-O0 --enable=peephole",
+]
+
+# a program that starts with /* smaller: A than B */ must also come out
+# in fewer instructions under flags A than under flags B
+
+def instr_count(compile_path, flags, test_file):
+    result = subprocess.run(
+        f"{compile_path} --chk_decl --gen_code {flags} < {test_file}",
+        shell=True,
+        capture_output=True,
+        text=True,
+        check=False
+    )
+    count = 0
+    for line in result.stdout.splitlines():
+        line = line.strip()
+        if line and not line.startswith(('#', '.')) and not line.endswith(':'):
+            count += 1
+    return count
+
+def main():
+    base_dir = os.path.dirname(os.path.abspath(__file__))
+    tests_dir = os.path.join(base_dir, "tests")
+    expected_dir = os.path.join(base_dir, "expected-outputs")
+    sim_path = os.path.join(base_dir, "mips_sim.py")
+
+    if not os.path.isdir(tests_dir):
+        print(f"Error: {tests_dir} directory not found")
+        sys.exit(1)
+
+    if not os.path.isdir(expected_dir):
+        print(f"Error: {expected_dir} directory not found")
+        sys.exit(1)
+
+    compile_path = "./compile"
+    if not os.path.isfile(compile_path) or not os.access(compile_path, os.X_OK):
+        print("Error: 'compile' executable not found or not executable")
+        sys.exit(1)
+
+    total = 0
+    passed = 0
+    failed = 0
+
+    print("===== Runtime Test Results =====")
+
+    for filename in sorted(os.listdir(tests_dir)):
+        test_file = os.path.join(tests_dir, filename)
+        if not os.path.isfile(test_file):
+            continue
+
+        expected_file = os.path.join(expected_dir, f"{filename}-out")
+        if not os.path.isfile(expected_file):
+            print(f"Warning: Expected output file not found for {filename}, skipping test")
+            continue
+
+        with open(expected_file, 'r') as f:
+            expected_output = f.read()
+
+        for flags in FLAG_SETS:
+            name = f"{filename} {flags}"
+            total += 1
+            try:
+                result = subprocess.run(
+                    f"{compile_path} --chk_decl --gen_code {flags} < {test_file}",
+                    shell=True,
+                    capture_output=True,
+                    text=True,
+                    check=False
+                )
+                if result.returncode != 0 or result.stderr:
+                    print(f"\n[FAIL] {name}")
+                    print("  Compile failed:")
+                    print(f"  {result.stderr}")
+                    failed += 1
+                    continue
+
+                run = subprocess.run(
+                    [sys.executable, sim_path, "/dev/stdin"],
+                    input=result.stdout,
+                    capture_output=True,
+                    text=True,
+                    check=False
+                )
+                actual_output = run.stdout
+
+                if run.returncode == 0 and actual_output == expected_output:
+                    passed += 1
+                else:
+                    print(f"\n[FAIL] {name}")
+                    if run.stderr:
+                        print(f"  {run.stderr}")
+                    print("Differences found:")
+                    diff = difflib.unified_diff(
+                        actual_output.splitlines(),
+                        expected_output.splitlines(),
+                        fromfile='Output',
+                        tofile='Expected',
+                        lineterm=''
+                    )
+                    for line in diff:
+                        print(f"  {line}")
+                    failed += 1
+
+            except Exception as e:
+                print(f"\n[ERROR] {name}: {str(e)}")
+                failed += 1
+
+        with open(test_file, 'r') as f:
+            match = re.match(r'/\*\s*smaller:(.*?)\bthan\b(.*?)\*/', f.readline())
+        if match:
+            small, large = match.group(1).strip(), match.group(2).strip()
+            total += 1
+            small_count = instr_count(compile_path, small, test_file)
+            large_count = instr_count(compile_path, large, test_file)
+            if small_count < large_count:
+                passed += 1
+            else:
+                print(f"\n[FAIL] {filename} smaller")
+                print(f"  {small_count} instrs under {small}, {large_count} under {large}")
+                failed += 1
+
+    print("\n===== Summary =====")
+    print(f"Total tests: {total}")
+    print(f"Passed:      {passed}")
+    print(f"Failed:      {failed}")
+
+    if failed == 0:
+        print("All tests passed!")
+        sys.exit(0)
+    else:
+        print("Some tests failed!")
+        sys.exit(1)
+
+if __name__ == "__main__":
+    main()